@@ -5,6 +5,9 @@ TEMPLATE = app
 
 CONFIG += c++17
 
+# QFuture::then(context, ...) needs Qt 6.1
+!versionAtLeast(QT_VERSION, 6.1.0): error("Baseball_Program requires Qt 6.1 or later (found $$QT_VERSION)")
+
 # Platform-specific configurations
 win32 {
     LIBS += -L$$[QT_INSTALL_LIBS]
@@ -18,20 +21,63 @@ SOURCES += \
     src/main.cpp \
     src/mainwindow.cpp \
     src/database.cpp \
+    src/schemamigrator.cpp \
+    src/databaseservice.cpp \
+    src/querycache.cpp \
+    src/teamcatalog.cpp \
+    src/teamfilterdialog.cpp \
     src/adminpanel.cpp \
     src/souvenirdialog.cpp \
     src/tripplanner.cpp \
     src/stadiumgraph.cpp \
+    src/csrgraph.cpp \
+    src/searchworkspace.cpp \
+    src/distancematrix.cpp \
+    src/heldkarp.cpp \
+    src/tourimprover.cpp \
+    src/optimaltour.cpp \
+    src/stadiumnameindex.cpp \
+    src/teamstadiumindex.cpp \
+    src/souvenircatalog.cpp \
+    src/attributedictionary.cpp \
+    src/csvreader.cpp \
+    src/distancecsv.cpp \
+    src/teamcsv.cpp \
+    src/importwriter.cpp \
+    src/importpipeline.cpp \
     src/trip.cpp \
     src/adminlogindialog.cpp
 
 HEADERS += \
     src/mainwindow.h \
     src/database.h \
+    src/schemamigrator.h \
+    src/databaseservice.h \
+    src/querycache.h \
+    src/teamcatalog.h \
+    src/rowbitmap.h \
+    src/teamfilterdialog.h \
     src/adminpanel.h \
     src/souvenirdialog.h \
     src/tripplanner.h \
     src/stadiumgraph.h \
+    src/csrgraph.h \
+    src/searchworkspace.h \
+    src/distancematrix.h \
+    src/heldkarp.h \
+    src/tourimprover.h \
+    src/optimaltour.h \
+    src/disjointset.h \
+    src/stadiumnameindex.h \
+    src/teamstadiumindex.h \
+    src/souvenircatalog.h \
+    src/attributedictionary.h \
+    src/csvreader.h \
+    src/distancecsv.h \
+    src/teamcsv.h \
+    src/importwriter.h \
+    src/boundedqueue.h \
+    src/importpipeline.h \
     src/trip.h \
     src/adminlogindialog.h
 
@@ -39,6 +85,7 @@ FORMS += \
     src/mainwindow.ui \
     src/adminpanel.ui \
     src/souvenirdialog.ui \
+    src/teamfilterdialog.ui \
     src/ui/tripplanner.ui \
     src/ui/adminlogindialog.ui
 
@@ -1,15 +1,16 @@
 #include "adminpanel.h"
 #include "ui_adminpanel.h"
+#include "databaseservice.h"
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QInputDialog>
 #include <QDebug>
 #include <QPushButton>
 #include <QRegularExpression>
-#include <QFile>
-#include <QTextStream>
 #include <QApplication>
 #include <QThread>
+#include <QProgressDialog>
+#include <QTimer>
 
 AdminPanel::AdminPanel(Database* database, StadiumGraph* stadiumGraph, QWidget *parent)
     : QDialog(parent)
@@ -21,6 +22,22 @@ AdminPanel::AdminPanel(Database* database, StadiumGraph* stadiumGraph, QWidget *
     setupUi();
     loadTeams();
     loadStadiumData(); // Load existing stadium data
+
+    // Writes (ours or anyone's) come back as deltas on the tables
+    connect(db, &Database::teamUpserted, this, &AdminPanel::applyTeamChange);
+    connect(db, &Database::souvenirAdded, this, [this](const QString &teamName, const QString &itemName, double price) {
+        applySouvenirChange(teamName, itemName, price, false);
+    });
+    connect(db, &Database::souvenirUpdated, this, [this](const QString &teamName, const QString &itemName, double price) {
+        applySouvenirChange(teamName, itemName, price, false);
+    });
+    connect(db, &Database::souvenirRemoved, this, [this](const QString &teamName, const QString &itemName) {
+        applySouvenirChange(teamName, itemName, 0.0, true);
+    });
+    connect(db, &Database::stadiumMapReloaded, this, [this]() {
+        loadTeams();
+        loadStadiumData();
+    });
     
     // Load initial souvenirs for the first team
     if (ui->teamComboBox->count() > 0) {
@@ -80,11 +97,17 @@ void AdminPanel::loadTeams()
 void AdminPanel::loadSouvenirs(const QString &teamName)
 {
     qDebug() << "Loading souvenirs for team:" << teamName;
+    db->async()->getSouvenirs(teamName).then(this, [this, teamName](const QVector<QPair<QString, double>> &souvenirs) {
+        // The selection may have moved on while the query ran
+        if (teamName == ui->teamComboBox->currentText()) {
+            showSouvenirs(souvenirs);
+        }
+    });
+}
+
+void AdminPanel::showSouvenirs(const QVector<QPair<QString, double>> &souvenirs)
+{
     ui->souvenirTable->setRowCount(0);
-    
-    auto souvenirs = db->getSouvenirs(teamName);
-    qDebug() << "Got souvenirs, adding to table...";
-    
     int rowCount = 0;
     for (const auto &souvenir : souvenirs) {
         int row = ui->souvenirTable->rowCount();
@@ -101,6 +124,61 @@ void AdminPanel::loadSouvenirs(const QString &teamName)
     ui->souvenirTable->resizeColumnsToContents();
 }
 
+void AdminPanel::applySouvenirChange(const QString &teamName, const QString &itemName, double price, bool removed)
+{
+    if (teamName != ui->teamComboBox->currentText()) {
+        return;
+    }
+    int row = 0;
+    while (row < ui->souvenirTable->rowCount() && ui->souvenirTable->item(row, 0)->text() != itemName) {
+        ++row;
+    }
+    if (removed) {
+        if (row < ui->souvenirTable->rowCount()) {
+            ui->souvenirTable->removeRow(row);
+        }
+        return;
+    }
+    if (row == ui->souvenirTable->rowCount()) {
+        // Keep the item_name order loadSouvenirs() shows
+        row = 0;
+        while (row < ui->souvenirTable->rowCount() && ui->souvenirTable->item(row, 0)->text() < itemName) {
+            ++row;
+        }
+        ui->souvenirTable->insertRow(row);
+        ui->souvenirTable->setItem(row, 0, new QTableWidgetItem(itemName));
+    }
+    ui->souvenirTable->setItem(row, 1, new QTableWidgetItem(QString::number(price, 'f', 2)));
+}
+
+void AdminPanel::applyTeamChange(const QString &teamName)
+{
+    if (ui->teamComboBox->findText(teamName) < 0) {
+        int index = 0;
+        while (index < ui->teamComboBox->count() && ui->teamComboBox->itemText(index) < teamName) {
+            ++index;
+        }
+        ui->teamComboBox->insertItem(index, teamName);
+    }
+
+    // Same columns and formatting as loadStadiumData(), from the in-memory catalog
+    const QueryResult info = db->teamCatalog()->teamInfo(teamName);
+    if (info.rowCount() == 0) {
+        return;
+    }
+    int row = 0;
+    while (row < ui->stadiumTable->rowCount()
+           && (!ui->stadiumTable->item(row, 0) || ui->stadiumTable->item(row, 0)->text() != teamName)) {
+        ++row;
+    }
+    if (row == ui->stadiumTable->rowCount()) {
+        ui->stadiumTable->insertRow(row);
+    }
+    for (int col = 0; col < info.rows.first().size() && col < 10; ++col) {
+        ui->stadiumTable->setItem(row, col, new QTableWidgetItem(info.value(0, col).toString()));
+    }
+}
+
 void AdminPanel::on_importStadiumButton_clicked()
 {
     QStringList fileNames = QFileDialog::getOpenFileNames(this,
@@ -110,34 +188,78 @@ void AdminPanel::on_importStadiumButton_clicked()
     if (fileNames.isEmpty())
         return;
 
-    // Clear the stadium table
-    ui->stadiumTable->setRowCount(0);
-
-    // Start the import process
-    if (db->importFromCSV(fileNames)) {
-        // Load all teams into the table
-        QSqlQuery query = db->getAllTeamsSortedByTeamName();
-        while (query.next()) {
-            int row = ui->stadiumTable->rowCount();
-            ui->stadiumTable->insertRow(row);
-
-            // Get full team info
-            QSqlQuery teamInfo = db->getTeamInfo(query.value(0).toString());
-            if (teamInfo.next()) {
-                for (int col = 0; col < 10; ++col) {
-                    QTableWidgetItem* item = new QTableWidgetItem(teamInfo.value(col).toString());
-                    ui->stadiumTable->setItem(row, col, item);
-                }
-            }
-        }
+    startImport(ImportPipeline::Teams, fileNames);
+}
 
-        QMessageBox::information(this, tr("Success"),
-            tr("Stadium data imported successfully! You can now review and edit the data."));
-        loadTeams();
-    } else {
-        QMessageBox::critical(this, tr("Error"),
-            tr("Failed to import stadium data. Please check the CSV format."));
+void AdminPanel::startImport(ImportPipeline::Kind kind, const QStringList &fileNames)
+{
+    if (activeImport) {
+        QMessageBox::information(this, tr("Import Running"), tr("Please wait for the current import to finish."));
+        return;
     }
+
+    // The import runs on worker threads with its own connection; this dialog
+    // stays usable and only shows progress
+    activeImport = new ImportPipeline(kind, fileNames, db->database().databaseName(), db->queryCache(),
+                                      db->teamCatalog(), kind == ImportPipeline::Teams ? db->teamNames() : QSet<QString>(), this);
+    ui->importStadiumButton->setEnabled(false);
+    ui->importDistancesButton->setEnabled(false);
+
+    QProgressDialog* progress = new QProgressDialog(
+        kind == ImportPipeline::Teams ? tr("Importing stadium data...") : tr("Importing distances..."),
+        tr("Cancel"), 0, 0, this);
+    progress->setWindowModality(Qt::NonModal);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    progress->setMinimumDuration(0);
+    progress->show();
+
+    QTimer* refresh = new QTimer(progress);
+    ImportPipeline* pipeline = activeImport;
+    connect(refresh, &QTimer::timeout, progress, [progress, pipeline]() {
+        ImportProgress p = pipeline->progress();
+        progress->setLabelText(QString("Read %1 rows, wrote %2 (%3 rows/s), %4 invalid")
+                                   .arg(p.rowsRead)
+                                   .arg(p.rowsWritten)
+                                   .arg(p.rowsPerSecond(), 0, 'f', 0)
+                                   .arg(p.errors));
+    });
+    refresh->start(250);
+
+    connect(progress, &QProgressDialog::canceled, pipeline, &ImportPipeline::cancel);
+    connect(pipeline, &ImportPipeline::finished, this, [this, progress, pipeline](bool ok, const QString &message) {
+        progress->close();
+        progress->deleteLater();
+        const ImportPipeline::Kind kind = pipeline->kind();
+        activeImport = nullptr;
+        pipeline->deleteLater();
+        ui->importStadiumButton->setEnabled(true);
+        ui->importDistancesButton->setEnabled(true);
+        importFinished(kind, ok, message);
+    });
+    activeImport->start();
+}
+
+void AdminPanel::importFinished(ImportPipeline::Kind kind, bool ok, const QString &message)
+{
+    if (!ok) {
+        QMessageBox::critical(this, tr("Import Error"), message);
+        return;
+    }
+
+    if (kind == ImportPipeline::Distances) {
+        db->notifyDistancesChanged();  // the stadium graph reloads on this
+        QMessageBox::information(this, "Import Successful", "Distances imported successfully.\n" + message);
+        // Debug: Print unreachable stadiums and missing paths
+        stadiumGraph->debugPrintUnreachableStadiums();
+        stadiumGraph->debugPrintAllMissingPaths();
+        return;
+    }
+
+    db->loadStadiumMap();  // reloads the tables through stadiumMapReloaded
+
+    QMessageBox::information(this, tr("Success"),
+        tr("Stadium data imported successfully! You can now review and edit the data.") + "\n" + message);
 }
 
 void AdminPanel::on_addSouvenirButton_clicked()
@@ -160,17 +282,12 @@ void AdminPanel::on_addSouvenirButton_clicked()
     if (!ok)
         return;
 
-    QSqlQuery query(db->database());
-    query.prepare("INSERT INTO souvenirs (team_name, item_name, price) VALUES (:team, :item, :price)");
-    query.bindValue(":team", teamName);
-    query.bindValue(":item", itemName);
-    query.bindValue(":price", price);
-
-    if (query.exec()) {
-        loadSouvenirs(teamName);
-    } else {
-        QMessageBox::critical(this, "Error", "Failed to add souvenir: " + query.lastError().text());
-    }
+    db->async()->addSouvenir(teamName, itemName, price).then(this, [this](const QueryResult &result) {
+        // On success the table is patched through Database::souvenirAdded
+        if (!result.ok()) {
+            QMessageBox::critical(this, "Error", "Failed to add souvenir: " + result.error);
+        }
+    });
 }
 
 void AdminPanel::on_editSouvenirButton_clicked()
@@ -192,17 +309,12 @@ void AdminPanel::on_editSouvenirButton_clicked()
     if (!ok)
         return;
 
-    QSqlQuery query(db->database());
-    query.prepare("UPDATE souvenirs SET price = :price WHERE team_name = :team AND item_name = :item");
-    query.bindValue(":price", newPrice);
-    query.bindValue(":team", teamName);
-    query.bindValue(":item", currentItemName);
-
-    if (query.exec()) {
-        loadSouvenirs(teamName);
-    } else {
-        QMessageBox::critical(this, "Error", "Failed to update souvenir: " + query.lastError().text());
-    }
+    db->async()->updateSouvenirPrice(teamName, currentItemName, newPrice).then(this, [this](const QueryResult &result) {
+        // On success the table is patched through Database::souvenirUpdated
+        if (!result.ok()) {
+            QMessageBox::critical(this, "Error", "Failed to update souvenir: " + result.error);
+        }
+    });
 }
 
 void AdminPanel::on_deleteSouvenirButton_clicked()
@@ -222,16 +334,12 @@ void AdminPanel::on_deleteSouvenirButton_clicked()
         return;
     }
 
-    QSqlQuery query(db->database());
-    query.prepare("DELETE FROM souvenirs WHERE team_name = :team AND item_name = :item");
-    query.bindValue(":team", teamName);
-    query.bindValue(":item", itemName);
-
-    if (query.exec()) {
-        loadSouvenirs(teamName);
-    } else {
-        QMessageBox::critical(this, "Error", "Failed to delete souvenir: " + query.lastError().text());
-    }
+    db->async()->deleteSouvenir(teamName, itemName).then(this, [this](const QueryResult &result) {
+        // On success the table is patched through Database::souvenirRemoved
+        if (!result.ok()) {
+            QMessageBox::critical(this, "Error", "Failed to delete souvenir: " + result.error);
+        }
+    });
 }
 
 void AdminPanel::on_teamComboBox_currentIndexChanged(const QString &teamName)
@@ -246,25 +354,23 @@ void AdminPanel::on_closeButton_clicked()
 
 void AdminPanel::loadStadiumData()
 {
-    // Clear the stadium table
-    ui->stadiumTable->setRowCount(0);
-
-    // Load all teams into the table
-    QSqlQuery query = db->getAllTeamsSortedByTeamName();
-    while (query.next()) {
-        int row = ui->stadiumTable->rowCount();
-        ui->stadiumTable->insertRow(row);
-
-        // Get full team info
-        QSqlQuery teamInfo = db->getTeamInfo(query.value(0).toString());
-        if (teamInfo.next()) {
-            for (int col = 0; col < 10; ++col) {
-                QTableWidgetItem* item = new QTableWidgetItem(teamInfo.value(col).toString());
+    // One query on a reader for every team's row; the GUI thread only fills the table
+    db->async()->read([](Database &reader) {
+        QSqlQuery query = reader.getAllTeamInfo();
+        return QueryResult::fromQuery(query);
+    }).then(this, [this](const QueryResult &result) {
+        if (!result.ok()) {
+            qDebug() << "Error loading stadium data:" << result.error;
+        }
+        ui->stadiumTable->setRowCount(result.rowCount());
+        for (int row = 0; row < result.rowCount(); ++row) {
+            for (int col = 0; col < result.rows[row].size() && col < 10; ++col) {
+                QTableWidgetItem* item = new QTableWidgetItem(result.value(row, col).toString());
                 ui->stadiumTable->setItem(row, col, item);
             }
         }
-    }
-    ui->stadiumTable->resizeColumnsToContents();
+        ui->stadiumTable->resizeColumnsToContents();
+    });
 }
 
 void AdminPanel::on_importDistancesButton_clicked() {
@@ -288,15 +394,7 @@ void AdminPanel::on_importDistancesButton_clicked() {
         return;
     }
 
-    if (db->importDistancesFromCSV(filename)) {
-        stadiumGraph->loadFromDatabase(db);
-        QMessageBox::information(this, "Import Successful", "Distances imported successfully.");
-        // Debug: Print unreachable stadiums and missing paths
-        stadiumGraph->debugPrintUnreachableStadiums();
-        stadiumGraph->debugPrintAllMissingPaths();
-    } else {
-        QMessageBox::critical(this, "Import Error", "Failed to import distances from CSV.");
-    }
+    startImport(ImportPipeline::Distances, QStringList{filename});
 }
 
 void AdminPanel::on_addStadiumButton_clicked()
@@ -316,8 +414,10 @@ void AdminPanel::on_addStadiumButton_clicked()
 
 void AdminPanel::on_saveStadiumChangesButton_clicked()
 {
-    db->database().transaction();
-    bool success = true;
+    // Validate on the GUI thread, then write every row in one transaction on
+    // the service's writer
+    QVector<TeamRecord> teams;
+    teams.reserve(ui->stadiumTable->rowCount());
     for (int row = 0; row < ui->stadiumTable->rowCount(); ++row) {
         QString teamName = ui->stadiumTable->item(row, 0)->text();
         QString stadiumName = ui->stadiumTable->item(row, 1)->text();
@@ -326,7 +426,6 @@ void AdminPanel::on_saveStadiumChangesButton_clicked()
         int capacity = capacityText.toInt(&ok);
         if (!ok || capacity < 0) {
             QMessageBox::critical(this, "Error", QString("Invalid capacity value for %1: %2\nPlease enter a valid number.").arg(teamName).arg(ui->stadiumTable->item(row, 2)->text()));
-            db->database().rollback();
             return;
         }
         QString location = ui->stadiumTable->item(row, 3)->text();
@@ -336,23 +435,26 @@ void AdminPanel::on_saveStadiumChangesButton_clicked()
         QString centerFieldStr = ui->stadiumTable->item(row, 7)->text();
         QString typology = ui->stadiumTable->item(row, 8)->text();
         QString roof = ui->stadiumTable->item(row, 9)->text();
-        QRegularExpression feetRegex("(\\d+)\\s*(?:feet|$)");
+        static const QRegularExpression feetRegex("(\\d+)\\s*(?:feet|$)");
         auto feetMatch = feetRegex.match(centerFieldStr);
         int centerField = 0;
         if (feetMatch.hasMatch()) {
             centerField = feetMatch.captured(1).toInt();
         }
-        if (!db->insertTeam(teamName, stadiumName, capacity, location, surface, league, dateOpened, centerField, typology, roof)) {
-            success = false;
-            break;
-        }
-    }
-    if (success && db->database().commit()) {
-        db->reloadStadiumData();
-        emit dataChanged();
-        QMessageBox::information(this, "Success", "Changes have been made successfully!");
-    } else {
-        db->database().rollback();
-        QMessageBox::critical(this, "Error", "Failed to save changes. Please try again.");
+        teams.append(TeamRecord{teamName, stadiumName, capacity, location, surface, league,
+                                dateOpened, centerField, typology, roof});
     }
+
+    ui->saveStadiumChangesButton->setEnabled(false);
+    db->async()->saveTeams(teams).then(this, [this](const QueryResult &result) {
+        ui->saveStadiumChangesButton->setEnabled(true);
+        if (result.ok()) {
+            // The map, main window and this table update from Database::teamUpserted
+            emit dataChanged();
+            QMessageBox::information(this, "Success", "Changes have been made successfully!");
+        } else {
+            qDebug() << "Saving stadium changes failed:" << result.error;
+            QMessageBox::critical(this, "Error", "Failed to save changes. Please try again.");
+        }
+    });
 } 
\ No newline at end of file
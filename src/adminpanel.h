@@ -7,6 +7,7 @@
 #include <QSqlError>
 #include "database.h"
 #include "stadiumgraph.h"
+#include "importpipeline.h"
 
 namespace Ui {
 class AdminPanel;
@@ -41,10 +42,16 @@ private:
     void setupUi();
     void loadTeams();
     void loadSouvenirs(const QString &teamName);
+    void showSouvenirs(const QVector<QPair<QString, double>> &souvenirs);
+    void applyTeamChange(const QString &teamName);
+    void applySouvenirChange(const QString &teamName, const QString &itemName, double price, bool removed);
     void loadStadiumData();
     void clearSouvenirFields();
     bool validateSouvenirInput();
     QString currentTeam;
+    ImportPipeline* activeImport = nullptr;  // running CSV import, if any
+    void startImport(ImportPipeline::Kind kind, const QStringList &fileNames);
+    void importFinished(ImportPipeline::Kind kind, bool ok, const QString &message);
 };
 
 #endif // ADMINPANEL_H 
\ No newline at end of file
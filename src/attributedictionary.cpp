@@ -0,0 +1,91 @@
+#include "attributedictionary.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDebug>
+#include <algorithm>
+
+AttributeDictionary &AttributeDictionary::leagues()
+{
+    static AttributeDictionary dictionary;
+    return dictionary;
+}
+
+AttributeDictionary &AttributeDictionary::surfaces()
+{
+    static AttributeDictionary dictionary;
+    return dictionary;
+}
+
+AttributeDictionary &AttributeDictionary::typologies()
+{
+    static AttributeDictionary dictionary;
+    return dictionary;
+}
+
+AttributeDictionary &AttributeDictionary::roofs()
+{
+    static AttributeDictionary dictionary;
+    return dictionary;
+}
+
+AttributeDictionary::AttributeDictionary()
+{
+    values.append(QString());
+    codes.insert(QString(), 0);
+    rankByCode.append(0);
+}
+
+AttributeCode AttributeDictionary::encode(const QString &value)
+{
+    const QString text = value.trimmed();
+    {
+        QReadLocker locker(&lock);
+        auto it = codes.constFind(text);
+        if (it != codes.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&lock);
+    auto it = codes.constFind(text);  // another thread may have added it meanwhile
+    if (it != codes.constEnd()) {
+        return it.value();
+    }
+    if (values.size() > 0xFFFF) {
+        qDebug() << "Attribute dictionary full; storing" << text << "as empty";
+        return 0;
+    }
+    const AttributeCode code = AttributeCode(values.size());
+    values.append(text);
+    codes.insert(text, code);
+
+    // New values are rare, so the ranks are simply rebuilt
+    QVector<int> byText(values.size());
+    for (int i = 0; i < byText.size(); ++i) {
+        byText[i] = i;
+    }
+    std::sort(byText.begin(), byText.end(), [this](int a, int b) { return values[a] < values[b]; });
+    rankByCode.resize(values.size());
+    for (int rank = 0; rank < byText.size(); ++rank) {
+        rankByCode[byText[rank]] = rank;
+    }
+    return code;
+}
+
+QString AttributeDictionary::decode(AttributeCode code) const
+{
+    QReadLocker locker(&lock);
+    return code < values.size() ? values[code] : QString();
+}
+
+QVector<int> AttributeDictionary::ranks() const
+{
+    QReadLocker locker(&lock);
+    return rankByCode;
+}
+
+int AttributeDictionary::size() const
+{
+    QReadLocker locker(&lock);
+    return values.size();
+}
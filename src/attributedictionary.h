@@ -0,0 +1,40 @@
+#ifndef ATTRIBUTEDICTIONARY_H
+#define ATTRIBUTEDICTIONARY_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+typedef quint16 AttributeCode;  // 0 is the empty value
+
+// Interns the values of one low-cardinality text field (league, surface,
+// typology, roof) so records store a two-byte code instead of a string.
+// Codes are never reused or removed, so one stays valid for the life of the
+// program. ranks() orders the codes by their text: sorting on the field
+// compares two integers, and existing codes keep their relative order when
+// a value is added. Shared by every thread; lookups lock.
+class AttributeDictionary {
+public:
+    static AttributeDictionary &leagues();
+    static AttributeDictionary &surfaces();
+    static AttributeDictionary &typologies();
+    static AttributeDictionary &roofs();
+
+    AttributeCode encode(const QString &value);  // trimmed; adds unseen values
+    QString decode(AttributeCode code) const;    // empty for unknown codes
+    QVector<int> ranks() const;                  // indexed by code
+    int size() const;
+
+private:
+    AttributeDictionary();
+    AttributeDictionary(const AttributeDictionary &) = delete;
+    AttributeDictionary &operator=(const AttributeDictionary &) = delete;
+
+    mutable QReadWriteLock lock;
+    QVector<QString> values;  // by code
+    QHash<QString, AttributeCode> codes;
+    QVector<int> rankByCode;
+};
+
+#endif // ATTRIBUTEDICTIONARY_H
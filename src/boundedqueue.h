@@ -0,0 +1,72 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QWaitCondition>
+
+// Fixed-capacity blocking FIFO between two pipeline stages. push() waits while
+// the queue is full, pop() while it is empty. close() lets the consumer drain
+// what is left; abort() wakes everyone and drops the contents (cancellation).
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(int capacity) : capacity(qMax(1, capacity)) {}
+
+    // False if the queue was closed or aborted; the item is dropped
+    bool push(T item) {
+        QMutexLocker locker(&mutex);
+        while (items.size() >= capacity && !closed) {
+            notFull.wait(&mutex);
+        }
+        if (closed) {
+            return false;
+        }
+        items.enqueue(std::move(item));
+        notEmpty.wakeOne();
+        return true;
+    }
+
+    // False once the queue is closed and empty, or aborted
+    bool pop(T& item) {
+        QMutexLocker locker(&mutex);
+        while (items.isEmpty() && !closed) {
+            notEmpty.wait(&mutex);
+        }
+        if (items.isEmpty() || aborted) {
+            return false;
+        }
+        item = items.dequeue();
+        notFull.wakeOne();
+        return true;
+    }
+
+    // No more pushes; pop() keeps returning items until the queue is empty
+    void close() {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        notEmpty.wakeAll();
+        notFull.wakeAll();
+    }
+
+    void abort() {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        aborted = true;
+        items.clear();
+        notEmpty.wakeAll();
+        notFull.wakeAll();
+    }
+
+private:
+    const int capacity;
+    QQueue<T> items;
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    bool closed = false;
+    bool aborted = false;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,67 @@
+#include "csrgraph.h"
+#include <QPair>
+#include <algorithm>
+
+void CsrGraph::build(int nodeCount, const QVector<CsrEdge>& edges) {
+    offsets = QVector<int>(nodeCount + 1, 0);
+    targets = QVector<int>(edges.size() * 2);
+    weights = QVector<double>(edges.size() * 2);
+
+    // Count the degree of every node, then turn the counts into row offsets
+    for (const CsrEdge& e : edges) {
+        ++offsets[e.from + 1];
+        ++offsets[e.to + 1];
+    }
+    for (int u = 0; u < nodeCount; ++u) {
+        offsets[u + 1] += offsets[u];
+    }
+
+    // Scatter both directions of every edge into its row
+    QVector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (const CsrEdge& e : edges) {
+        int a = fill[e.from]++;
+        targets[a] = e.to;
+        weights[a] = e.weight;
+        int b = fill[e.to]++;
+        targets[b] = e.from;
+        weights[b] = e.weight;
+    }
+
+    // Sort each row by target so weightBetween can binary search
+    QVector<QPair<int, double>> row;
+    for (int u = 0; u < nodeCount; ++u) {
+        int begin = offsets[u];
+        int end = offsets[u + 1];
+        row.clear();
+        for (int a = begin; a < end; ++a) {
+            row.append(qMakePair(targets[a], weights[a]));
+        }
+        std::sort(row.begin(), row.end(),
+                  [](const QPair<int, double>& x, const QPair<int, double>& y) {
+                      return x.first < y.first;
+                  });
+        for (int i = 0; i < row.size(); ++i) {
+            targets[begin + i] = row[i].first;
+            weights[begin + i] = row[i].second;
+        }
+    }
+}
+
+void CsrGraph::clear() {
+    offsets.clear();
+    targets.clear();
+    weights.clear();
+}
+
+double CsrGraph::weightBetween(int u, int v) const {
+    if (u < 0 || v < 0 || u >= nodeCount() || v >= nodeCount()) {
+        return -1.0;
+    }
+    auto first = targets.constBegin() + offsets[u];
+    auto last = targets.constBegin() + offsets[u + 1];
+    auto it = std::lower_bound(first, last, v);
+    if (it == last || *it != v) {
+        return -1.0;
+    }
+    return weights[int(it - targets.constBegin())];
+}
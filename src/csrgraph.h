@@ -0,0 +1,38 @@
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include <QVector>
+
+// Undirected edge between two dense stadium IDs, used to (re)build the CSR arrays
+struct CsrEdge {
+    int from;
+    int to;
+    double weight;
+};
+
+// Compressed-sparse-row adjacency over dense integer node IDs.
+// The neighbours of node u are targets[offsets[u]] .. targets[offsets[u + 1] - 1]
+// (sorted by ID), with the matching distances in weights.
+class CsrGraph {
+public:
+    void build(int nodeCount, const QVector<CsrEdge>& edges);
+    void clear();
+
+    int nodeCount() const { return offsets.isEmpty() ? 0 : offsets.size() - 1; }
+    int arcCount() const { return targets.size(); }
+    int degree(int u) const { return offsets[u + 1] - offsets[u]; }
+    int rowBegin(int u) const { return offsets[u]; }
+    int rowEnd(int u) const { return offsets[u + 1]; }
+    int target(int arc) const { return targets[arc]; }
+    double weight(int arc) const { return weights[arc]; }
+
+    // Weight of the direct edge u-v, or -1 if there is none
+    double weightBetween(int u, int v) const;
+
+private:
+    QVector<int> offsets;
+    QVector<int> targets;
+    QVector<double> weights;
+};
+
+#endif // CSRGRAPH_H
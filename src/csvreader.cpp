@@ -0,0 +1,335 @@
+#include "csvreader.h"
+#include <QtAlgorithms>
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <algorithm>
+#include <numeric>
+#include <climits>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CSVREADER_USE_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSVREADER_USE_SSE2
+#endif
+
+namespace {
+
+bool isStructural(char c) {
+    return c == '"' || c == ',' || c == '\n' || c == '\r';
+}
+
+bool isDelimiter(char c) {
+    return c == ',' || c == '\n' || c == '\r';
+}
+
+} // namespace
+
+CsvReader::CsvReader(const QString& filename)
+    : file(filename)
+{
+}
+
+CsvReader::CsvReader(const CsvReader& source, const Range& range)
+    : data(source.data)
+    , size(range.end)
+    , pos(range.begin)
+    , line(range.line)
+{
+}
+
+bool CsvReader::open() {
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    const qint64 length = file.size();
+    if (length > INT_MAX) {
+        error = "File is too large";
+        return false;
+    }
+    if (length > 0) {
+        if (uchar* mapped = file.map(0, length)) {
+            data = reinterpret_cast<const char*>(mapped);
+            size = int(length);
+        } else {
+            buffer = file.readAll();
+            data = buffer.constData();
+            size = int(buffer.size());
+        }
+    }
+    pos = 0;
+    line = 1;
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+        pos = 3;
+    }
+    return true;
+}
+
+int CsvReader::nextStructural(int p) const {
+#ifdef CSVREADER_USE_AVX2
+    {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i cr = _mm256_set1_epi8('\r');
+        const __m256i lf = _mm256_set1_epi8('\n');
+        for (; p + 32 <= size; p += 32) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + p));
+            __m256i hits = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(bytes, quote), _mm256_cmpeq_epi8(bytes, comma)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(bytes, cr), _mm256_cmpeq_epi8(bytes, lf)));
+            quint32 bits = quint32(_mm256_movemask_epi8(hits));
+            if (bits) {
+                return p + int(qCountTrailingZeroBits(bits));
+            }
+        }
+    }
+#endif
+#ifdef CSVREADER_USE_SSE2
+    {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i cr = _mm_set1_epi8('\r');
+        const __m128i lf = _mm_set1_epi8('\n');
+        for (; p + 16 <= size; p += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + p));
+            __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, comma)),
+                _mm_or_si128(_mm_cmpeq_epi8(bytes, cr), _mm_cmpeq_epi8(bytes, lf)));
+            quint32 bits = quint32(_mm_movemask_epi8(hits));
+            if (bits) {
+                return p + int(qCountTrailingZeroBits(bits));
+            }
+        }
+    }
+#endif
+    for (; p < size; ++p) {
+        if (isStructural(data[p])) {
+            return p;
+        }
+    }
+    return size;
+}
+
+int CsvReader::nextQuote(int p) const {
+    if (p >= size) {
+        return size;
+    }
+    // memchr is already vectorized by the C library
+    const void* hit = std::memchr(data + p, '"', size_t(size - p));
+    return hit ? int(static_cast<const char*>(hit) - data) : size;
+}
+
+// pos is on the opening quote. Leaves pos on the delimiter after the field.
+void CsvReader::parseQuoted(Field& f) {
+    const int start = pos + 1;
+    int q = nextQuote(start);
+    line += int(std::count(data + start, data + q, '\n'));
+
+    // Common case: "..." with no escapes, followed by a delimiter or the end
+    if (q < size && (q + 1 >= size || isDelimiter(data[q + 1]))) {
+        f = Field{start, q - start, false};
+        pos = q + 1;
+        return;
+    }
+    if (q >= size) {
+        // Unterminated quote: the field runs to the end of the input
+        f = Field{start, q - start, false};
+        pos = size;
+        return;
+    }
+
+    // Escaped quotes ("") or text after the closing quote: rebuild the field.
+    // Text between quoted sections is kept, like the old toggle-on-quote parser.
+    f = Field{int(scratch.size()), 0, true};
+    scratch.append(data + start, q - start);
+    while (true) {
+        if (q + 1 < size && data[q + 1] == '"') {
+            scratch.append('"');
+            const int p = q + 2;
+            q = nextQuote(p);
+            line += int(std::count(data + p, data + q, '\n'));
+            scratch.append(data + p, q - p);
+            if (q >= size) {
+                pos = size;
+                break;
+            }
+            continue;
+        }
+        // Closing quote; take anything up to the next delimiter as plain text
+        const int p = q + 1;
+        const int e = nextStructural(p);
+        scratch.append(data + p, e - p);
+        if (e < size && data[e] == '"') {
+            // Another quoted section starts inside the same field
+            q = nextQuote(e + 1);
+            line += int(std::count(data + e + 1, data + q, '\n'));
+            scratch.append(data + e + 1, q - e - 1);
+            if (q >= size) {
+                pos = size;
+                break;
+            }
+            continue;
+        }
+        pos = e;
+        break;
+    }
+    f.length = int(scratch.size()) - f.begin;
+}
+
+bool CsvReader::readRow() {
+    fields.clear();
+    scratch.clear();
+
+    // Skip blank lines (LF, CRLF or lone CR)
+    while (pos < size && (data[pos] == '\n' || data[pos] == '\r')) {
+        if (data[pos] == '\n' || pos + 1 >= size || data[pos + 1] != '\n') {
+            ++line;
+        }
+        ++pos;
+    }
+    if (pos >= size) {
+        return false;
+    }
+    rowLine = line;
+
+    while (true) {
+        Field f{pos, 0, false};
+        if (pos < size && data[pos] == '"') {
+            parseQuoted(f);
+        } else {
+            // Unquoted field; a stray quote inside it is literal text
+            int e = nextStructural(pos);
+            while (e < size && data[e] == '"') {
+                e = nextStructural(e + 1);
+            }
+            f.length = e - pos;
+            pos = e;
+        }
+        fields.append(f);
+
+        if (pos >= size) {
+            break;
+        }
+        const char c = data[pos++];
+        if (c == ',') {
+            continue;
+        }
+        // End of record
+        if (c == '\r' && pos < size && data[pos] == '\n') {
+            ++pos;
+        }
+        ++line;
+        break;
+    }
+    return true;
+}
+
+QByteArrayView CsvReader::field(int i) const {
+    if (i < 0 || i >= fields.size()) {
+        return QByteArrayView();
+    }
+    const Field& f = fields[i];
+    const char* base = f.inScratch ? scratch.constData() : data;
+    return QByteArrayView(base + f.begin, f.length);
+}
+
+QString CsvReader::text(int i) const {
+    return QString::fromUtf8(field(i)).trimmed();
+}
+
+double CsvReader::number(int i, bool* ok) const {
+    const QByteArrayView view = field(i);
+    return QByteArray::fromRawData(view.data(), view.size()).trimmed().toDouble(ok);
+}
+
+QVector<CsvReader::Range> CsvReader::split(int minChunkBytes) const {
+    QVector<Range> ranges;
+    const int total = size - pos;
+    if (total <= 0) {
+        return ranges;
+    }
+    const int maxChunks = qMax(1, QThreadPool::globalInstance()->maxThreadCount() * 4);
+    const int chunkCount = qBound(1, total / qMax(1, minChunkBytes), maxChunks);
+
+    // Walk the structural bytes once, tracking quote state the way readRow()
+    // does (a quote only opens a quoted section at the start of a field or
+    // right after a closing quote), and cut at the first record end past each target
+    int begin = pos;
+    int beginLine = line;
+    int p = pos;
+    int l = line;
+    bool inQuotes = false;
+    bool fieldStart = true;    // nothing read yet in the current field
+    bool quotedField = false;  // current field started with a quote
+    for (int i = 1; i < chunkCount; ++i) {
+        const int target = pos + int(qint64(total) * i / chunkCount);
+        if (target <= begin) {
+            continue;
+        }
+        bool cut = false;
+        while (p < size && !cut) {
+            const int next = nextStructural(p);
+            if (next > p) {
+                fieldStart = false;
+            }
+            if (next >= size) {
+                p = size;
+                break;
+            }
+            const char c = data[next];
+            p = next + 1;
+            if (c == '"') {
+                if (inQuotes) {
+                    inQuotes = false;
+                } else if (fieldStart || quotedField) {
+                    inQuotes = true;
+                    quotedField = true;
+                }
+                fieldStart = false;
+            } else if (inQuotes) {
+                if (c == '\n') {
+                    ++l;
+                }
+            } else if (c == ',') {
+                fieldStart = true;
+                quotedField = false;
+            } else {
+                // CR, LF or CRLF ends the record
+                if (c == '\r' && p < size && data[p] == '\n') {
+                    ++p;
+                }
+                ++l;
+                fieldStart = true;
+                quotedField = false;
+                cut = p >= target;
+            }
+        }
+        if (!cut || p >= size) {
+            break;
+        }
+        ranges.append(Range{begin, p, beginLine});
+        begin = p;
+        beginLine = l;
+    }
+    ranges.append(Range{begin, size, beginLine});
+    return ranges;
+}
+
+void CsvReader::parallelFor(const QVector<Range>& ranges,
+                            const std::function<void(int, CsvReader&)>& parse) const {
+    if (ranges.size() == 1) {
+        CsvReader rows(*this, ranges[0]);
+        parse(0, rows);
+        return;
+    }
+    QVector<int> chunks(ranges.size());
+    std::iota(chunks.begin(), chunks.end(), 0);
+    QtConcurrent::blockingMap(chunks, [&](int chunk) {
+        CsvReader rows(*this, ranges[chunk]);
+        parse(chunk, rows);
+    });
+}
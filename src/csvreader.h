@@ -0,0 +1,78 @@
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// Streaming RFC 4180 reader shared by the team and distance importers.
+// The file is memory-mapped (or read whole if mapping fails) and a leading
+// UTF-8 BOM is skipped. Rows are split by scanning 16/32 bytes at a time for
+// quotes, commas and line breaks (SSE2/AVX2 when available). Fields are views
+// into the mapped bytes; only fields with "" escapes or text after a closing
+// quote are rebuilt, in a per-row scratch buffer. Blank lines are skipped.
+//
+// Large files can be parsed in parallel: split() cuts the unread rows into
+// byte ranges that start on record boundaries (quote-aware), and
+// parallelFor() runs one sub-reader per range on the global thread pool.
+class CsvReader {
+public:
+    // Unread bytes [begin, end) starting on a record; line is its first line number
+    struct Range {
+        int begin;
+        int end;
+        int line;
+    };
+
+    explicit CsvReader(const QString& filename);
+
+    bool open();                    // false if the file can't be read; see errorString()
+    QString errorString() const { return error; }
+
+    // Advances to the next record; false at end of input. Field views stay
+    // valid until the next call.
+    bool readRow();
+    int lineNumber() const { return rowLine; }  // 1-based line the current row starts on
+
+    int fieldCount() const { return fields.size(); }
+    QByteArrayView field(int i) const;          // raw UTF-8, quotes removed, untrimmed
+    QString text(int i) const;                  // decoded and trimmed; empty if i is out of range
+    double number(int i, bool* ok = nullptr) const;
+
+    // Ranges covering everything after the current row, at most a few per pool
+    // thread and none much smaller than minChunkBytes; in file order
+    QVector<Range> split(int minChunkBytes = 256 * 1024) const;
+    // Calls parse(chunk, rows) for every range, concurrently; rows reads just that range.
+    // Returns once all chunks are done. This reader must outlive the call.
+    void parallelFor(const QVector<Range>& ranges,
+                     const std::function<void(int chunk, CsvReader& rows)>& parse) const;
+
+private:
+    CsvReader(const CsvReader& source, const Range& range);
+
+    struct Field {
+        int begin;          // offset into the input, or into scratch when inScratch
+        int length;
+        bool inScratch;
+    };
+
+    int nextStructural(int pos) const;  // first quote, comma, CR or LF at or after pos
+    int nextQuote(int pos) const;
+    void parseQuoted(Field& f);
+
+    QFile file;
+    QByteArray buffer;                  // fallback copy when the file can't be mapped
+    const char* data = nullptr;
+    int size = 0;
+    int pos = 0;
+    int line = 1;
+    int rowLine = 0;
+    QVector<Field> fields;
+    QByteArray scratch;
+    QString error;
+};
+
+#endif // CSVREADER_H
@@ -1,68 +1,168 @@
 #include "database.h"
-#include <QFile>
-#include <QTextStream>
-#include <QRegularExpression>
-#include <QStringConverter>
+#include "csvreader.h"
+#include "distancecsv.h"
+#include "teamcsv.h"
+#include "importwriter.h"
+#include "schemamigrator.h"
+#include "databaseservice.h"
 #include <QSqlError>
 #include <QStringList>
+#include <QSet>
+#include <QVariant>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
 
 Database::Database(QObject *parent)
     : QObject(parent)
+    , cache(new QueryCache)
+    , catalog(new TeamCatalog)
 {
     // Use in-memory database so imported CSV data is only kept for the current run.
     // When the program is closed or rebuilt, the database resets to the three preloaded teams.
     db = QSqlDatabase::addDatabase("QSQLITE");
     db.setDatabaseName("baseball.db");
+    db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(BusyTimeoutMs));
+}
+
+Database::Database(const QString &databaseName, const QString &connectionName, bool readOnly,
+                   const QSharedPointer<QueryCache> &cache, const QSharedPointer<TeamCatalog> &catalog,
+                   QObject *parent)
+    : QObject(parent)
+    , cache(cache)
+    , catalog(catalog)
+{
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(databaseName);
+    QString options = QString("QSQLITE_BUSY_TIMEOUT=%1").arg(BusyTimeoutMs);
+    if (readOnly) {
+        options += ";QSQLITE_OPEN_READONLY";
+    }
+    db.setConnectOptions(options);
 }
 
 Database::~Database()
 {
+    const QString name = db.connectionName();
     if (db.isOpen()) {
         db.close();
     }
+    if (name != QLatin1String(QSqlDatabase::defaultConnection)) {
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+}
+
+bool Database::open()
+{
+    if (!db.open()) {
+        qDebug() << "Error opening database:" << db.lastError().text();
+        return false;
+    }
+    return true;
 }
 
-void Database::loadStadiumMap()
+bool Database::loadStadiumMap()
 {
+    // Forward-only scans (the souvenir catalog, teams, then every team's own
+    // souvenir rows) merged in memory into a fresh map; the live map is only
+    // replaced once all of them succeed
+    QElapsedTimer timer;
+    timer.start();
+    HashMap<QString, StadiumInfo> loaded;
+
     QSqlQuery query(db);
-    query.exec("SELECT * FROM teams");
-    
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT item_name, price FROM souvenir_catalog ORDER BY item_id")) {
+        qDebug() << "Error loading souvenir catalog:" << query.lastError().text();
+        return false;
+    }
+    QSharedPointer<SouvenirCatalog> loadedCatalog(new SouvenirCatalog);
+    while (query.next()) {
+        loadedCatalog->append(query.value(0).toString(), query.value(1).toDouble());
+    }
+
+    if (!query.exec("SELECT team_id, team_name, stadium_name, capacity, location, surface, league, "
+                    "date_opened, center_field, typology, roof FROM teams")) {
+        qDebug() << "Error loading teams:" << query.lastError().text();
+        return false;
+    }
+    int teamRows = 0;
+    QVector<QPair<int, QString>> teamIds;
+    QVector<StadiumInfo> teams;
     while (query.next()) {
         StadiumInfo info;
-        info.teamName = query.value("team_name").toString();
-        info.stadiumName = query.value("stadium_name").toString();
-        info.seatingCapacity = query.value("capacity").toInt();
-        info.location = query.value("location").toString();
-        info.playingSurface = query.value("surface").toString();
-        info.league = query.value("league").toString();
-        info.dateOpened = query.value("date_opened").toString();
-        info.distanceToCenter = query.value("center_field").toInt();
-        info.ballparkTypology = query.value("typology").toString();
-        info.roofType = query.value("roof").toString();
-        
-        // Load souvenirs for this team
-        QSqlQuery souvenirQuery(db);
-        souvenirQuery.prepare("SELECT item_name, price FROM souvenirs WHERE team_name = :team");
-        souvenirQuery.bindValue(":team", info.teamName);
-        souvenirQuery.exec();
-        
-        while (souvenirQuery.next()) {
-            info.souvenirs.append(qMakePair(
-                souvenirQuery.value("item_name").toString(),
-                souvenirQuery.value("price").toDouble()
-            ));
-        }
-        
-        // Insert into our custom HashMap
-        stadiumMap.insert(info.teamName, info);
+        info.teamName = query.value(1).toString();
+        info.stadiumName = query.value(2).toString();
+        info.seatingCapacity = query.value(3).toInt();
+        info.location = query.value(4).toString();
+        info.distanceToCenter = query.value(8).toInt();
+        info.setAttributes(query.value(6).toString(), query.value(5).toString(),
+                           query.value(9).toString(), query.value(10).toString(),
+                           query.value(7).toString());
+        info.souvenirs = SouvenirList(loadedCatalog);
+        teamIds.append(qMakePair(query.value(0).toInt(), info.teamName));
+        teams.append(info);
+        loaded.insert(info.teamName, info);
+        ++teamRows;
+    }
+
+    // The map is complete, so entry pointers stay valid from here on
+    QHash<int, StadiumInfo*> byId;
+    byId.reserve(teamIds.size());
+    for (const auto &team : teamIds) {
+        byId.insert(team.first, loaded.find(team.second));
+    }
+
+    // Rowid order keeps each team's own items in insertion order; a team's
+    // rows are usually adjacent, so the id lookup only runs when it changes
+    if (!query.exec("SELECT team_id, item_name, price, hidden FROM souvenirs ORDER BY souvenir_id")) {
+        qDebug() << "Error loading souvenirs:" << query.lastError().text();
+        return false;
     }
+    int souvenirRows = 0;
+    int orphanRows = 0;
+    int currentTeam = 0;
+    StadiumInfo* current = nullptr;
+    bool first = true;
+    while (query.next()) {
+        const int team = query.value(0).toInt();
+        if (first || team != currentTeam) {
+            currentTeam = team;
+            current = byId.value(currentTeam, nullptr);
+            first = false;
+        }
+        if (!current) {
+            ++orphanRows;  // souvenir for a team that is not in the teams table
+            continue;
+        }
+        current->souvenirs.addOverride(query.value(1).toString(), query.value(2).toDouble(),
+                                       query.value(3).toInt() != 0);
+        ++souvenirRows;
+    }
+
+    stadiumMap.swap(loaded);
+    souvenirCatalog = loadedCatalog;
+    teamIndex.sync(stadiumMap);
+    catalog->reset(teams);
+
+    lastLoad.teams = teamRows;
+    lastLoad.catalogSouvenirs = loadedCatalog->size();
+    lastLoad.souvenirs = souvenirRows;
+    lastLoad.orphanSouvenirs = orphanRows;
+    lastLoad.elapsedMs = timer.elapsed();
+    qDebug() << "Loaded" << teamRows << "teams," << lastLoad.catalogSouvenirs << "catalog souvenirs and"
+             << souvenirRows << "team souvenir rows in" << lastLoad.elapsedMs << "ms";
+    if (orphanRows > 0) {
+        qDebug() << "Skipped" << orphanRows << "souvenirs with no matching team";
+    }
+    emit stadiumMapReloaded();
+    return true;
 }
 
 bool Database::initialize()
 {
-    if (!db.open()) {
-        qDebug() << "Error opening database:" << db.lastError().text();
+    if (!open()) {
         return false;
     }
 
@@ -73,7 +173,7 @@ bool Database::initialize()
     // Start a transaction for faster inserts
     db.transaction();
     
-    insertInitialData();  // This now handles both teams and souvenirs
+    insertInitialData();  // teams; their souvenirs come from the catalog
     loadStadiumMap();     // Update the stadium map with the new data
     
     // Commit the transaction
@@ -82,51 +182,34 @@ bool Database::initialize()
         db.rollback();
         return false;
     }
+    invalidateCache(QueryCache::Teams | QueryCache::Souvenirs);
+
+    // WAL lets the service's reader connections run while its writer commits
+    QSqlQuery pragma(db);
+    if (!pragma.exec("PRAGMA journal_mode = WAL")) {
+        qDebug() << "Could not enable WAL:" << pragma.lastError().text();
+    }
+    if (!service) {
+        service = new DatabaseService(db.databaseName(), cache, catalog, this);
+        // Emitted from the writer thread; queued onto this (GUI) thread
+        connect(service, &DatabaseService::teamsSaved, this, &Database::applyTeamsSaved);
+        connect(service, &DatabaseService::souvenirAdded, this, &Database::applySouvenirAdded);
+        connect(service, &DatabaseService::souvenirUpdated, this, &Database::applySouvenirUpdated);
+        connect(service, &DatabaseService::souvenirRemoved, this, &Database::applySouvenirRemoved);
+        connect(service, &DatabaseService::catalogPriceUpdated, this, &Database::applyCatalogPriceUpdated);
+    }
 
     return true;
 }
 
 bool Database::createTables()
 {
-    QSqlQuery query(db);
-    
-    // Create teams table
-    if (!query.exec("CREATE TABLE IF NOT EXISTS teams ("
-                   "team_name TEXT PRIMARY KEY,"
-                   "stadium_name TEXT,"
-                   "capacity INTEGER,"
-        "location TEXT,"
-                   "surface TEXT,"
-        "league TEXT,"
-                   "date_opened TEXT,"
-                   "center_field INTEGER,"
-                   "typology TEXT,"
-                   "roof TEXT)")) {
-        qDebug() << "Error creating teams table:" << query.lastError().text();
+    // Creates the tables in a new file and upgrades older files in place
+    SchemaMigrator migrator(db);
+    if (!migrator.migrate()) {
+        qDebug() << "Error creating tables:" << migrator.lastError();
         return false;
     }
-
-    // Create souvenirs table
-    if (!query.exec("CREATE TABLE IF NOT EXISTS souvenirs ("
-                   "team_name TEXT,"
-                   "item_name TEXT,"
-                   "price REAL,"
-                   "PRIMARY KEY (team_name, item_name),"
-                   "FOREIGN KEY (team_name) REFERENCES teams(team_name))")) {
-        qDebug() << "Error creating souvenirs table:" << query.lastError().text();
-        return false;
-    }
-
-    // Create distances table
-    if (!query.exec("CREATE TABLE IF NOT EXISTS distances ("
-                   "from_team TEXT,"
-                   "to_team TEXT,"
-                   "distance INTEGER,"
-                   "PRIMARY KEY (from_team, to_team))")) {
-        qDebug() << "Error creating distances table:" << query.lastError().text();
-        return false;
-    }
-
     return true;
 }
 
@@ -142,29 +225,8 @@ void Database::insertInitialData()
     insertTeam("Los Angeles Dodgers", "Dodger Stadium", 56000, "Los Angeles, CA", "Grass",
                "National", "1962", 400, "Modern", "Open");
 
-    // Add default souvenirs for each team
-    QStringList teams = {"Boston Red Sox", "New York Yankees", "Los Angeles Dodgers"};
-    QVector<QPair<QString, double>> defaultSouvenirs = {
-        {"Baseball cap", 19.99},
-        {"Baseball bat", 89.39},
-        {"Team pennant", 17.99},
-        {"Autographed baseball", 29.99},
-        {"Team jersey", 199.99}
-    };
-
-    for (const QString &team : teams) {
-        for (const auto &souvenir : defaultSouvenirs) {
-            QSqlQuery query(db);
-            query.prepare("INSERT INTO souvenirs (team_name, item_name, price) VALUES (:team, :item, :price)");
-            query.bindValue(":team", team);
-            query.bindValue(":item", souvenir.first);
-            query.bindValue(":price", souvenir.second);
-            if (!query.exec()) {
-                qDebug() << "Error adding souvenir" << souvenir.first << "for team" << team 
-                        << ":" << query.lastError().text();
-            }
-        }
-    }
+    // Every team sells the souvenir_catalog items (seeded by the schema
+    // migration), so there are no per-team souvenir rows to add
 }
 
 void Database::initializeSouvenirs()
@@ -173,32 +235,43 @@ void Database::initializeSouvenirs()
     // Keep it empty as it's called from initialize()
 }
 
+// The ten team info columns, formatted for display
+static const char *const TeamInfoColumns =
+    "SELECT team_name, stadium_name, "
+    "printf('%,d', capacity) as capacity, "
+    "location, surface, league, date_opened, "
+    "CASE "
+    "  WHEN center_field > 0 THEN printf('%d feet (%d m)', center_field, CAST(ROUND(center_field * 0.3048) AS INTEGER)) "
+    "  ELSE '0' "
+    "END as center_field, "
+    "typology, roof "
+    "FROM teams ";
+
 QSqlQuery Database::getTeamInfo(const QString &teamName)
 {
     QSqlQuery query(db);
-    query.prepare(
-        "SELECT team_name, stadium_name, "
-        "printf('%,d', capacity) as capacity, "
-        "location, surface, league, date_opened, "
-        "CASE "
-        "  WHEN center_field > 0 THEN printf('%d feet (%d m)', center_field, CAST(ROUND(center_field * 0.3048) AS INTEGER)) "
-        "  ELSE '0' "
-        "END as center_field, "
-        "typology, roof "
-        "FROM teams WHERE TRIM(team_name) = TRIM(:team)");
-    query.bindValue(":team", teamName);
+    query.prepare(QString(TeamInfoColumns) + "WHERE team_name = :team");
+    query.bindValue(":team", teamName.trimmed());
     if (!query.exec()) {
         qDebug() << "Error getting team info:" << query.lastError().text();
     }
     return query;
 }
 
+QSqlQuery Database::getAllTeamInfo()
+{
+    QSqlQuery query(db);
+    if (!query.exec(QString(TeamInfoColumns) + "WHERE team_name != '' ORDER BY team_name")) {
+        qDebug() << "Error getting all team info:" << query.lastError().text();
+    }
+    return query;
+}
+
 QSqlQuery Database::getAllTeamsSortedByTeamName()
 {
     QSqlQuery query(db);
-    if (!query.exec("SELECT TRIM(team_name) as team_name, TRIM(stadium_name) as stadium_name "
-                   "FROM teams WHERE team_name IS NOT NULL AND team_name != '' "
-                   "ORDER BY TRIM(team_name)")) {
+    if (!query.exec("SELECT team_name, stadium_name FROM teams "
+                   "WHERE team_name != '' ORDER BY team_name")) {
         qDebug() << "Error getting teams by name:" << query.lastError().text();
     }
     return query;
@@ -207,9 +280,8 @@ QSqlQuery Database::getAllTeamsSortedByTeamName()
 QSqlQuery Database::getAllTeamsSortedByStadiumName()
 {
     QSqlQuery query(db);
-    if (!query.exec("SELECT TRIM(team_name) as team_name, TRIM(stadium_name) as stadium_name "
-                   "FROM teams WHERE stadium_name IS NOT NULL AND stadium_name != '' "
-                   "ORDER BY TRIM(stadium_name)")) {
+    if (!query.exec("SELECT team_name, stadium_name FROM teams "
+                   "WHERE stadium_name != '' ORDER BY stadium_name")) {
         qDebug() << "Error getting teams by stadium:" << query.lastError().text();
     }
     return query;
@@ -218,9 +290,8 @@ QSqlQuery Database::getAllTeamsSortedByStadiumName()
 QSqlQuery Database::getAmericanLeagueTeams()
 {
     QSqlQuery query(db);
-    if (!query.exec("SELECT TRIM(team_name) as team_name, TRIM(stadium_name) as stadium_name "
-                   "FROM teams WHERE TRIM(UPPER(league)) = 'AMERICAN' "
-                   "ORDER BY TRIM(team_name)")) {
+    if (!query.exec("SELECT team_name, stadium_name FROM teams "
+                   "WHERE league_key = 'AMERICAN' ORDER BY team_name")) {
         qDebug() << "Error getting American League teams:" << query.lastError().text();
     }
     return query;
@@ -229,9 +300,8 @@ QSqlQuery Database::getAmericanLeagueTeams()
 QSqlQuery Database::getNationalLeagueTeams()
 {
     QSqlQuery query(db);
-    if (!query.exec("SELECT TRIM(team_name) as team_name, TRIM(stadium_name) as stadium_name "
-                   "FROM teams WHERE TRIM(UPPER(league)) = 'NATIONAL' "
-                   "ORDER BY TRIM(team_name)")) {
+    if (!query.exec("SELECT team_name, stadium_name FROM teams "
+                   "WHERE league_key = 'NATIONAL' ORDER BY team_name")) {
         qDebug() << "Error getting National League teams:" << query.lastError().text();
     }
     return query;
@@ -240,10 +310,8 @@ QSqlQuery Database::getNationalLeagueTeams()
 QSqlQuery Database::getTeamsByTypology()
 {
     QSqlQuery query(db);
-    if (!query.exec("SELECT TRIM(stadium_name) as stadium_name, TRIM(team_name) as team_name, "
-                   "TRIM(typology) as typology FROM teams "
-                   "WHERE typology IS NOT NULL AND typology != '' "
-                   "ORDER BY TRIM(typology), TRIM(team_name)")) {
+    if (!query.exec("SELECT stadium_name, team_name, typology FROM teams "
+                   "WHERE typology != '' ORDER BY typology, team_name")) {
         qDebug() << "Error getting teams by typology:" << query.lastError().text();
     }
     return query;
@@ -252,9 +320,8 @@ QSqlQuery Database::getTeamsByTypology()
 QSqlQuery Database::getOpenRoofTeams()
 {
     QSqlQuery query(db);
-    if (!query.exec("SELECT TRIM(team_name) as team_name FROM teams "
-                   "WHERE TRIM(UPPER(roof)) = 'OPEN' AND team_name IS NOT NULL "
-                   "ORDER BY TRIM(team_name)")) {
+    if (!query.exec("SELECT team_name FROM teams "
+                   "WHERE roof_key = 'OPEN' ORDER BY team_name")) {
         qDebug() << "Error getting open roof teams:" << query.lastError().text();
     }
     return query;
@@ -263,10 +330,8 @@ QSqlQuery Database::getOpenRoofTeams()
 QSqlQuery Database::getTeamsByDateOpened()
 {
     QSqlQuery query(db);
-    if (!query.exec("SELECT TRIM(stadium_name) as stadium_name, TRIM(team_name) as team_name, "
-                   "TRIM(date_opened) as date_opened FROM teams "
-                   "WHERE date_opened IS NOT NULL AND date_opened != '' "
-                   "ORDER BY date_opened")) {
+    if (!query.exec("SELECT stadium_name, team_name, date_opened FROM teams "
+                   "WHERE date_opened != '' ORDER BY date_opened")) {
         qDebug() << "Error getting teams by date:" << query.lastError().text();
     }
     return query;
@@ -290,8 +355,7 @@ QSqlQuery Database::getTeamsWithGreatestCenterField()
         "   FROM teams "
         "   WHERE center_field > 0"
         ") "
-        "SELECT TRIM(stadium_name) as stadium_name, "
-        "       TRIM(team_name) as team_name, "
+        "SELECT stadium_name, team_name, "
         "       printf('%d feet (%d m)', center_field, CAST(ROUND(center_field * 0.3048) AS INTEGER)) as center_field "
         "FROM teams "
         "WHERE center_field = (SELECT max_distance FROM MaxDistance) "
@@ -310,8 +374,7 @@ QSqlQuery Database::getTeamsWithSmallestCenterField()
         "   FROM teams "
         "   WHERE center_field > 0"
         ") "
-        "SELECT TRIM(stadium_name) as stadium_name, "
-        "       TRIM(team_name) as team_name, "
+        "SELECT stadium_name, team_name, "
         "       printf('%d feet (%d m)', center_field, CAST(ROUND(center_field * 0.3048) AS INTEGER)) as center_field "
         "FROM teams "
         "WHERE center_field = (SELECT min_distance FROM MinDistance) "
@@ -321,6 +384,70 @@ QSqlQuery Database::getTeamsWithSmallestCenterField()
     return query;
 }
 
+QueryResult Database::cachedListing(Listing listing, const QString &teamName)
+{
+    if (listing != Listing::TeamSouvenirs && catalog->isLoaded()) {
+        switch (listing) {
+        case Listing::TeamInfo:            return catalog->teamInfo(teamName);
+        case Listing::TeamsByTeamName:     return catalog->teamsByTeamName();
+        case Listing::TeamsByStadiumName:  return catalog->teamsByStadiumName();
+        case Listing::AmericanLeagueTeams: return catalog->teamsInLeague("AMERICAN");
+        case Listing::NationalLeagueTeams: return catalog->teamsInLeague("NATIONAL");
+        case Listing::TeamsByTypology:     return catalog->teamsByTypology();
+        case Listing::OpenRoofTeams:       return catalog->openRoofTeams();
+        case Listing::TeamsByDateOpened:   return catalog->teamsByDateOpened();
+        case Listing::TeamsByCapacity:     return catalog->teamsByCapacity();
+        case Listing::GreatestCenterField: return catalog->greatestCenterField();
+        case Listing::SmallestCenterField: return catalog->smallestCenterField();
+        case Listing::TeamSouvenirs:       break;
+        }
+    }
+
+    const QueryCache::Key key(int(listing), teamName.trimmed());
+    QueryResult result;
+    if (cache->find(key, result)) {
+        return result;
+    }
+
+    // Stamp before reading: a write that commits while the query runs moves
+    // the generation, and the stale rows are not stored
+    const QueryCache::Stamp readAt = cache->stamp();
+    QueryCache::Tables tables = QueryCache::Teams;
+    QSqlQuery query(db);
+    switch (listing) {
+    case Listing::TeamInfo:            query = getTeamInfo(teamName); break;
+    case Listing::TeamsByTeamName:     query = getAllTeamsSortedByTeamName(); break;
+    case Listing::TeamsByStadiumName:  query = getAllTeamsSortedByStadiumName(); break;
+    case Listing::AmericanLeagueTeams: query = getAmericanLeagueTeams(); break;
+    case Listing::NationalLeagueTeams: query = getNationalLeagueTeams(); break;
+    case Listing::TeamsByTypology:     query = getTeamsByTypology(); break;
+    case Listing::OpenRoofTeams:       query = getOpenRoofTeams(); break;
+    case Listing::TeamsByDateOpened:   query = getTeamsByDateOpened(); break;
+    case Listing::TeamsByCapacity:     query = getTeamsByCapacity(); break;
+    case Listing::GreatestCenterField: query = getTeamsWithGreatestCenterField(); break;
+    case Listing::SmallestCenterField: query = getTeamsWithSmallestCenterField(); break;
+    case Listing::TeamSouvenirs:
+        query = getTeamSouvenirs(teamName);
+        tables |= QueryCache::Souvenirs;
+        break;
+    }
+    result = QueryResult::fromQuery(query);
+    if (result.ok()) {
+        cache->insert(key, tables, readAt, result);
+    }
+    return result;
+}
+
+QueryResult Database::filterTeams(const TeamFilter &conditions)
+{
+    if (!catalog->isLoaded()) {
+        QueryResult result;
+        result.error = "Team data is not loaded";
+        return result;
+    }
+    return catalog->filter(conditions);
+}
+
 bool Database::importFromCSV(const QStringList &filenames)
 {
     if (filenames.isEmpty()) {
@@ -345,6 +472,7 @@ bool Database::importFromCSV(const QStringList &filenames)
             db.rollback();
             return false;
         }
+        invalidateCache(QueryCache::Teams | QueryCache::Souvenirs);
         // Reload the stadium map after import
         loadStadiumMap();
     } else {
@@ -356,191 +484,111 @@ bool Database::importFromCSV(const QStringList &filenames)
 
 bool Database::importSingleCSV(const QString &filename)
 {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "Error opening file:" << file.errorString();
+    CsvReader reader(filename);
+    if (!reader.open()) {
+        qDebug() << "Error opening file:" << reader.errorString();
         return false;
     }
-
-    QTextStream in(&file);
     // Skip header line
-    if (!in.atEnd()) {
-        in.readLine();
-    }
-
-    // Default souvenirs that each team should have
-    QVector<QPair<QString, double>> defaultSouvenirs = {
-        {"Baseball cap", 19.99},
-        {"Baseball bat", 89.39},
-        {"Team pennant", 17.99},
-        {"Autographed baseball", 29.99},
-        {"Team jersey", 199.99}
-    };
-
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        QStringList fields;
-        bool inQuotes = false;
-        QString currentField;
-        
-        // Custom CSV parsing to handle quoted fields
-        for (int i = 0; i < line.length(); ++i) {
-            QChar currentChar = line[i];
-            
-            if (currentChar == '"') {
-                inQuotes = !inQuotes;
-            } else if (currentChar == ',' && !inQuotes) {
-                fields.append(currentField.trimmed());
-                currentField.clear();
-            } else {
-                currentField += currentChar;
-            }
-        }
-        // Add the last field
-        fields.append(currentField.trimmed());
-        
-        // Remove quotes from fields
-        for (int i = 0; i < fields.size(); ++i) {
-            fields[i].remove('"');
+    reader.readRow();
+
+    // Repeats within the file are dropped here; teams already in the
+    // database are left alone by the insert's ON CONFLICT
+    QSet<QString> seenTeams;
+    QVector<TeamRecord> teams;
+    int skipped = 0;
+    QStringList fields;
+    while (reader.readRow()) {
+        fields.clear();
+        for (int i = 0; i < reader.fieldCount(); ++i) {
+            fields.append(reader.text(i));
         }
-        
-        if (fields.size() >= 10) {
-            QString teamName = fields[0].trimmed();
-            
-            // Skip empty team names
-            if (teamName.isEmpty()) {
+        TeamRecord team;
+        if (!TeamCsv::parseRow(fields, team)) {
             continue;
         }
-
-        // Check if team already exists
-            QSqlQuery checkQuery(db);
-            checkQuery.prepare("SELECT COUNT(*) FROM teams WHERE team_name = :team");
-            checkQuery.bindValue(":team", teamName);
-        checkQuery.exec();
-            checkQuery.next();
-            bool teamExists = checkQuery.value(0).toInt() > 0;
-
-            // If team exists, skip it
-            if (teamExists) {
-                qDebug() << "Team already exists, skipping:" << teamName;
-                continue;
-            }
-
-            QString stadiumName = fields[1].trimmed();
-            
-            // Clean up capacity data
-            QString capacityStr = fields[2].trimmed();
-            capacityStr.remove(QRegularExpression("[^0-9]"));
-            int capacity = capacityStr.toInt();
-            
-            QString location = fields[3].trimmed();
-            QString surface = fields[4].trimmed();
-            QString league = fields[5].trimmed();
-            
-            // Clean up date opened
-            QString dateOpened = fields[6].trimmed();
-            QRegularExpression yearRegex("\\b\\d{4}\\b");
-            auto match = yearRegex.match(dateOpened);
-            if (match.hasMatch()) {
-                dateOpened = match.captured(0);
-            }
-            
-            // Clean up center field distance
-            QString centerFieldStr = fields[7].trimmed();
-            // Extract just the feet value (before any parentheses)
-            QRegularExpression feetRegex("(\\d+)\\s*(?:feet|$)");
-            auto feetMatch = feetRegex.match(centerFieldStr);
-            int centerField = 0;
-            if (feetMatch.hasMatch()) {
-                centerField = feetMatch.captured(1).toInt();
-        } else {
-                // If no "feet" found, try to extract just the first number
-                QRegularExpression numberRegex("\\d+");
-                auto numberMatch = numberRegex.match(centerFieldStr);
-                if (numberMatch.hasMatch()) {
-                    centerField = numberMatch.captured(0).toInt();
-                }
-            }
-            
-            // Validate the center field value
-            if (centerField <= 0 || centerField > 1000) { // Sanity check for reasonable values
-                centerField = 0;
-            }
-            
-            QString typology = fields[8].trimmed();
-            QString roof = fields[9].trimmed();
-
-            // Validate and clean data
-            if (league.isEmpty()) league = "Unknown";
-            if (surface.isEmpty()) surface = "Unknown";
-            if (typology.isEmpty()) typology = "Unknown";
-            if (roof.isEmpty()) roof = "Unknown";
-            
-            // Ensure capacity and center field are valid
-            if (capacity <= 0) capacity = 0;
-            if (centerField <= 0) centerField = 0;
-
-            qDebug() << "Inserting team:" << teamName;
-            if (!insertTeam(teamName, stadiumName, capacity, location, surface,
-                          league, dateOpened, centerField, typology, roof)) {
-                qDebug() << "Error inserting team:" << teamName;
-                file.close();
-                return false;
-            }
-
-            // Add default souvenirs for this team
-            for (const auto &souvenir : defaultSouvenirs) {
-                QSqlQuery souvenirQuery(db);
-                souvenirQuery.prepare(
-                    "INSERT INTO souvenirs (team_name, item_name, price) "
-                    "VALUES (:team, :item, :price)"
-                );
-                souvenirQuery.bindValue(":team", teamName);
-                souvenirQuery.bindValue(":item", souvenir.first);
-                souvenirQuery.bindValue(":price", souvenir.second);
-                
-                if (!souvenirQuery.exec()) {
-                    qDebug() << "Error adding souvenir" << souvenir.first 
-                            << "for team" << teamName 
-                            << ":" << souvenirQuery.lastError().text();
-                    file.close();
-                    return false;
-                }
-                qDebug() << "Added souvenir" << souvenir.first << "for team" << teamName;
-            }
+        if (seenTeams.contains(team.teamName)) {
+            ++skipped;
+            continue;
         }
+        seenTeams.insert(team.teamName);
+        teams.append(team);
     }
 
-    file.close();
+    // Rows the batch did not insert were teams that already exist
+    QSqlQuery changes(db);
+    auto totalChanges = [&changes]() {
+        return changes.exec("SELECT total_changes()") && changes.next() ? changes.value(0).toInt() : -1;
+    };
+    const int changesBefore = totalChanges();
+    ImportWriter writer(db);
+    if (!writer.writeTeams(teams)) {
+        return false;
+    }
+    const int changesAfter = totalChanges();
+    int imported = teams.size();
+    if (changesBefore >= 0 && changesAfter >= 0) {
+        imported = changesAfter - changesBefore;
+        skipped += teams.size() - imported;
+    }
+    if (skipped > 0) {
+        qDebug() << "Skipped" << skipped << "teams that already exist";
+    }
+    invalidateCache(QueryCache::Teams | QueryCache::Souvenirs);
+    qDebug() << "Imported" << imported << "teams from" << filename;
     return true;
 }
 
+QSet<QString> Database::teamNames() const
+{
+    QSet<QString> names;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT team_name FROM teams")) {
+        qDebug() << "Error reading team names:" << query.lastError().text();
+        return names;
+    }
+    while (query.next()) {
+        names.insert(query.value(0).toString());
+    }
+    return names;
+}
+
 bool Database::insertTeam(const QString &teamName, const QString &stadiumName,
                          int capacity, const QString &location, const QString &surface,
                          const QString &league, const QString &dateOpened,
                          int centerField, const QString &typology, const QString &roof)
 {
+    // Upsert rather than INSERT OR REPLACE, which would delete the row and
+    // give the team a new team_id, orphaning its souvenirs
     QSqlQuery query(db);
-    query.prepare("INSERT OR REPLACE INTO teams (team_name, stadium_name, capacity, location, "
+    query.prepare("INSERT INTO teams (team_name, stadium_name, capacity, location, "
                  "surface, league, date_opened, center_field, typology, roof) "
                  "VALUES (:team, :stadium, :capacity, :location, :surface, :league, "
-                 ":opened, :center, :typology, :roof)");
+                 ":opened, :center, :typology, :roof) "
+                 "ON CONFLICT(team_name) DO UPDATE SET stadium_name = excluded.stadium_name, "
+                 "capacity = excluded.capacity, location = excluded.location, "
+                 "surface = excluded.surface, league = excluded.league, "
+                 "date_opened = excluded.date_opened, center_field = excluded.center_field, "
+                 "typology = excluded.typology, roof = excluded.roof");
     
-    query.bindValue(":team", teamName);
-    query.bindValue(":stadium", stadiumName);
+    query.bindValue(":team", teamName.trimmed());
+    query.bindValue(":stadium", stadiumName.trimmed());
     query.bindValue(":capacity", capacity);
-    query.bindValue(":location", location);
-    query.bindValue(":surface", surface);
-    query.bindValue(":league", league);
-    query.bindValue(":opened", dateOpened);
+    query.bindValue(":location", location.trimmed());
+    query.bindValue(":surface", surface.trimmed());
+    query.bindValue(":league", league.trimmed());
+    query.bindValue(":opened", dateOpened.trimmed());
     query.bindValue(":center", centerField);
-    query.bindValue(":typology", typology);
-    query.bindValue(":roof", roof);
+    query.bindValue(":typology", typology.trimmed());
+    query.bindValue(":roof", roof.trimmed());
 
     if (!query.exec()) {
-        qDebug() << "Error inserting team:" << query.lastError().text();
+        error = query.lastError().text();
+        qDebug() << "Error inserting team:" << error;
         return false;
     }
+    invalidateCache(QueryCache::Teams);
 
     return true;
 }
@@ -551,11 +599,11 @@ QVector<QPair<QString, double>> Database::getSouvenirs(const QString &teamName)
     
     QSqlQuery query(db);
     query.prepare(
-        "SELECT item_name, price FROM souvenirs "
+        "SELECT item_name, price FROM team_souvenirs "
         "WHERE team_name = :team_name "
         "ORDER BY item_name"
     );
-    query.bindValue(":team_name", teamName);
+    query.bindValue(":team_name", teamName.trimmed());
     
     qDebug() << "Fetching souvenirs for team:" << teamName;
     
@@ -574,96 +622,265 @@ QVector<QPair<QString, double>> Database::getSouvenirs(const QString &teamName)
     return souvenirs;
 }
 
+QSqlQuery Database::getTeamSouvenirs(const QString &teamName)
+{
+    // Same order as SouvenirList::items()
+    QSqlQuery query(db);
+    query.prepare(
+        "SELECT item_name, price FROM team_souvenirs "
+        "WHERE team_name = :team_name "
+        "ORDER BY from_catalog DESC, position"
+    );
+    query.bindValue(":team_name", teamName.trimmed());
+    if (!query.exec()) {
+        error = query.lastError().text();
+        qDebug() << "Error fetching souvenirs:" << error;
+    }
+    return query;
+}
+
+bool Database::souvenirState(const QString &teamName, const QString &itemName,
+                             int &teamId, bool &catalogItem, bool &sold)
+{
+    QSqlQuery query(db);
+    query.prepare(
+        "SELECT t.team_id, "
+        "EXISTS (SELECT 1 FROM souvenir_catalog c WHERE c.item_name = :catalog_item), "
+        "EXISTS (SELECT 1 FROM team_souvenirs s WHERE s.team_name = :sold_by AND s.item_name = :team_item) "
+        "FROM teams t WHERE t.team_name = :team_name"
+    );
+    query.bindValue(":catalog_item", itemName.trimmed());
+    query.bindValue(":team_item", itemName.trimmed());
+    query.bindValue(":sold_by", teamName.trimmed());
+    query.bindValue(":team_name", teamName.trimmed());
+    if (!query.exec()) {
+        error = query.lastError().text();
+        return false;
+    }
+    if (!query.next()) {
+        error = "Team not found: " + teamName;
+        return false;
+    }
+    teamId = query.value(0).toInt();
+    catalogItem = query.value(1).toInt() != 0;
+    sold = query.value(2).toInt() != 0;
+    return true;
+}
+
 bool Database::addSouvenir(const QString &teamName, const QString &itemName, double price)
 {
+    int teamId = 0;
+    bool catalogItem = false;
+    bool sold = false;
+    if (!souvenirState(teamName, itemName, teamId, catalogItem, sold)) {
+        qDebug() << "Error adding souvenir:" << error;
+        return false;
+    }
+    if (sold) {
+        error = "Souvenir already exists: " + itemName;
+        qDebug() << "Error adding souvenir:" << error;
+        return false;
+    }
+
+    // A catalog item the team had dropped comes back at this price
     QSqlQuery query(db);
     query.prepare(
-        "INSERT INTO souvenirs (team_name, item_name, price) "
-        "VALUES (:team_name, :item_name, :price)"
+        "INSERT INTO souvenirs (team_id, item_name, price) VALUES (:team_id, :item_name, :price) "
+        "ON CONFLICT(team_id, item_name) DO UPDATE SET price = excluded.price, hidden = 0"
     );
-    query.bindValue(":team_name", teamName);
-    query.bindValue(":item_name", itemName);
+    query.bindValue(":team_id", teamId);
+    query.bindValue(":item_name", itemName.trimmed());
     query.bindValue(":price", price);
     
     if (!query.exec()) {
-        qDebug() << "Error adding souvenir:" << query.lastError().text();
+        error = query.lastError().text();
+        qDebug() << "Error adding souvenir:" << error;
         return false;
     }
+    invalidateCache(QueryCache::Souvenirs);
     return true;
 }
 
 bool Database::updateSouvenirPrice(const QString &teamName, const QString &itemName, double newPrice)
 {
+    int teamId = 0;
+    bool catalogItem = false;
+    bool sold = false;
+    if (!souvenirState(teamName, itemName, teamId, catalogItem, sold)) {
+        qDebug() << "Error updating souvenir price:" << error;
+        return false;
+    }
+    if (!sold) {
+        error = "Souvenir not found: " + itemName;
+        return false;
+    }
+
+    // For a catalog item this gives the team its own price
     QSqlQuery query(db);
     query.prepare(
-        "UPDATE souvenirs "
-        "SET price = :price "
-        "WHERE TRIM(team_name) = TRIM(:team_name) "
-        "AND TRIM(item_name) = TRIM(:item_name)"
+        "INSERT INTO souvenirs (team_id, item_name, price) VALUES (:team_id, :item_name, :price) "
+        "ON CONFLICT(team_id, item_name) DO UPDATE SET price = excluded.price"
     );
-    query.bindValue(":team_name", teamName);
-    query.bindValue(":item_name", itemName);
+    query.bindValue(":team_id", teamId);
+    query.bindValue(":item_name", itemName.trimmed());
     query.bindValue(":price", newPrice);
     
     if (!query.exec()) {
-        qDebug() << "Error updating souvenir price:" << query.lastError().text();
+        error = query.lastError().text();
+        qDebug() << "Error updating souvenir price:" << error;
         return false;
     }
-    return query.numRowsAffected() > 0;
+    invalidateCache(QueryCache::Souvenirs);
+    return true;
 }
 
 bool Database::deleteSouvenir(const QString &teamName, const QString &itemName)
 {
+    int teamId = 0;
+    bool catalogItem = false;
+    bool sold = false;
+    if (!souvenirState(teamName, itemName, teamId, catalogItem, sold)) {
+        qDebug() << "Error deleting souvenir:" << error;
+        return false;
+    }
+    if (!sold) {
+        error = "Souvenir not found: " + itemName;
+        return false;
+    }
+
+    // Catalog items stay in the catalog; the team's row hides it from them
     QSqlQuery query(db);
-    query.prepare(
-        "DELETE FROM souvenirs "
-        "WHERE TRIM(team_name) = TRIM(:team_name) "
-        "AND TRIM(item_name) = TRIM(:item_name)"
-    );
-    query.bindValue(":team_name", teamName);
-    query.bindValue(":item_name", itemName);
+    if (catalogItem) {
+        query.prepare(
+            "INSERT INTO souvenirs (team_id, item_name, price, hidden) VALUES (:team_id, :item_name, NULL, 1) "
+            "ON CONFLICT(team_id, item_name) DO UPDATE SET price = NULL, hidden = 1"
+        );
+    } else {
+        query.prepare(
+            "DELETE FROM souvenirs WHERE team_id = :team_id AND item_name = :item_name"
+        );
+    }
+    query.bindValue(":team_id", teamId);
+    query.bindValue(":item_name", itemName.trimmed());
     
     if (!query.exec()) {
-        qDebug() << "Error deleting souvenir:" << query.lastError().text();
+        error = query.lastError().text();
+        qDebug() << "Error deleting souvenir:" << error;
         return false;
     }
-    return query.numRowsAffected() > 0;
+    invalidateCache(QueryCache::Souvenirs);
+    return true;
+}
+
+bool Database::updateCatalogPrice(const QString &itemName, double newPrice)
+{
+    // One row, whatever the number of teams
+    QSqlQuery query(db);
+    query.prepare("UPDATE souvenir_catalog SET price = :price WHERE item_name = :item_name");
+    query.bindValue(":item_name", itemName.trimmed());
+    query.bindValue(":price", newPrice);
+
+    if (!query.exec()) {
+        error = query.lastError().text();
+        qDebug() << "Error updating catalog price:" << error;
+        return false;
+    }
+    if (query.numRowsAffected() == 0) {
+        error = "Not a catalog souvenir: " + itemName;
+        return false;
+    }
+    invalidateCache(QueryCache::Souvenirs);
+    return true;
 }
 
 StadiumInfo Database::getStadiumInfo(const QString &teamName) const
 {
-    StadiumInfo info;
-    if (!stadiumMap.get(teamName, info)) {
+    const StadiumInfo* info = stadiumMap.find(teamName);
+    if (!info) {
         qDebug() << "Team not found:" << teamName;
+        return StadiumInfo();
     }
-    return info;
+    return *info;
 }
 
 QVector<StadiumInfo> Database::getAllStadiums() const
 {
     QVector<StadiumInfo> stadiums;
-    auto entries = stadiumMap.getAllEntries();
-    for (const auto &entry : entries) {
-        stadiums.append(entry.second);
+    stadiums.reserve(stadiumMap.size());
+    for (const auto &entry : stadiumMap) {
+        stadiums.append(entry.value);
     }
     return stadiums;
 }
 
 bool Database::updateSouvenirInMap(const QString &teamName, const QString &itemName, double newPrice)
 {
-    StadiumInfo info;
-    if (!stadiumMap.get(teamName, info)) {
+    StadiumInfo* info = stadiumMap.find(teamName);
+    if (!info) {
         return false;
     }
-    
-    for (auto &souvenir : info.souvenirs) {
-        if (souvenir.first == itemName) {
-            souvenir.second = newPrice;
-            stadiumMap.insert(teamName, info);  // Update the map
-            return true;
+    return info->souvenirs.setPrice(itemName, newPrice);  // Update the map in place
+}
+
+void Database::applyTeamsSaved(const QVector<TeamRecord> &teams)
+{
+    for (const TeamRecord &team : teams) {
+        const QString name = team.teamName.trimmed();
+        StadiumInfo* info = stadiumMap.find(name);
+        if (!info) {
+            StadiumInfo added;
+            added.teamName = name;
+            added.souvenirs = SouvenirList(souvenirCatalog);  // new teams sell the catalog
+            stadiumMap.insert(name, added);
+            info = stadiumMap.find(name);
+        }
+        // Same trimming as insertTeam(); souvenirs are left alone
+        info->stadiumName = team.stadiumName.trimmed();
+        info->seatingCapacity = team.capacity;
+        info->location = team.location.trimmed();
+        info->distanceToCenter = team.centerField;
+        info->setAttributes(team.league, team.surface, team.typology, team.roof, team.dateOpened);
+        teamIndex.upsert(name, info->stadiumName);
+        emit teamUpserted(name);
+    }
+}
+
+void Database::applySouvenirAdded(const QString &teamName, const QString &itemName, double price)
+{
+    if (StadiumInfo* info = stadiumMap.find(teamName)) {
+        info->souvenirs.append(itemName, price);
+    }
+    emit souvenirAdded(teamName, itemName, price);
+}
+
+void Database::applySouvenirUpdated(const QString &teamName, const QString &itemName, double price)
+{
+    updateSouvenirInMap(teamName, itemName, price);
+    emit souvenirUpdated(teamName, itemName, price);
+}
+
+void Database::applySouvenirRemoved(const QString &teamName, const QString &itemName)
+{
+    if (StadiumInfo* info = stadiumMap.find(teamName)) {
+        info->souvenirs.remove(itemName);
+    }
+    emit souvenirRemoved(teamName, itemName);
+}
+
+void Database::applyCatalogPriceUpdated(const QString &itemName, double price)
+{
+    if (souvenirCatalog) {
+        souvenirCatalog->setPrice(itemName, price);
+    }
+    emit catalogPriceUpdated(itemName, price);
+    // Every list shares the catalog, so only listeners need telling, and only
+    // about teams that actually sell the item at the catalog price
+    for (const auto &entry : stadiumMap) {
+        const SouvenirList &souvenirs = entry.value.souvenirs;
+        if (souvenirs.contains(itemName) && !souvenirs.hasOwnPrice(itemName)) {
+            emit souvenirUpdated(entry.key, itemName, price);
         }
     }
-    return false;
 }
 
 bool Database::validateAdmin(const QString &username, const QString &password)
@@ -675,40 +892,29 @@ bool Database::validateAdmin(const QString &username, const QString &password)
 
 bool Database::importDistancesFromCSV(const QString &filename)
 {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << "Error opening distances file:" << file.errorString();
+    // Parsed in parallel chunks; rows are bound in file order, so a pair that
+    // appears twice still ends up with its last distance
+    QVector<DistanceRecord> records;
+    if (!DistanceCsv::read(filename, false, records)) {
         return false;
     }
-    QTextStream in(&file);
-    // Skip header line
-    if (!in.atEnd()) {
-        in.readLine();
+    if (records.isEmpty()) {
+        return true;
     }
+
     db.transaction();
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        QStringList fields = line.split(',');
-        if (fields.size() < 3) continue;
-        QString from = fields[0].trimmed();
-        QString to = fields[1].trimmed();
-        bool ok = false;
-        double distance = fields[2].trimmed().toDouble(&ok);
-        if (!ok || from.isEmpty() || to.isEmpty()) continue;
-        QSqlQuery query(db);
-        query.prepare("INSERT OR REPLACE INTO distances (from_team, to_team, distance) VALUES (:from, :to, :distance)");
-        query.bindValue(":from", from);
-        query.bindValue(":to", to);
-        query.bindValue(":distance", distance);
-        if (!query.exec()) {
-            qDebug() << "Error inserting distance:" << query.lastError().text();
-            db.rollback();
-            file.close();
-            return false;
-        }
+    ImportWriter writer(db);
+    if (!writer.writeDistances(records)) {
+        db.rollback();
+        return false;
+    }
+    if (!db.commit()) {
+        qDebug() << "Error committing distances:" << db.lastError().text();
+        db.rollback();
+        return false;
     }
-    db.commit();
-    file.close();
+    invalidateCache(QueryCache::Distances);
+    emit distancesChanged();
     return true;
 }
 
@@ -716,7 +922,9 @@ QVector<QPair<QString, QPair<QString, double>>> Database::getAllDistances() cons
 {
     QVector<QPair<QString, QPair<QString, double>>> distances;
     QSqlQuery query(db);
-    if (query.exec("SELECT from_team, to_team, distance FROM distances")) {
+    if (query.exec("SELECT f.name, t.name, d.distance FROM distances d "
+                   "JOIN stadiums f ON f.stadium_id = d.from_id "
+                   "JOIN stadiums t ON t.stadium_id = d.to_id")) {
         while (query.next()) {
             QString from = query.value(0).toString();
             QString to = query.value(1).toString();
@@ -6,30 +6,57 @@
 #include <QSqlQuery>
 #include <QVector>
 #include <QPair>
+#include <QSet>
+#include <QSharedPointer>
 #include "stadiuminfo.h"
 #include "hashmap.h"
+#include "querycache.h"
+#include "teamcatalog.h"
+#include "teamstadiumindex.h"
+#include "teamcsv.h"
+
+class DatabaseService;
+
+// Row counts and timing of the last Database::loadStadiumMap()
+struct StadiumLoadStats {
+    int teams = 0;
+    int catalogSouvenirs = 0;  // souvenir_catalog rows, shared by every team
+    int souvenirs = 0;         // per-team souvenirs rows
+    int orphanSouvenirs = 0;  // souvenir rows whose team is missing
+    qint64 elapsedMs = 0;
+};
 
 class Database : public QObject
 {
     Q_OBJECT
 
 public:
+    static const int BusyTimeoutMs = 5000;  // how long a connection waits on another's lock
+
     explicit Database(QObject *parent = nullptr);
+    // Extra connection to the same file (one per DatabaseService worker thread),
+    // sharing the main connection's query cache and team catalog
+    Database(const QString &databaseName, const QString &connectionName, bool readOnly,
+             const QSharedPointer<QueryCache> &cache, const QSharedPointer<TeamCatalog> &catalog,
+             QObject *parent = nullptr);
     ~Database();
 
+    bool open();        // just opens the connection; initialize() also migrates and seeds
     bool initialize();
     bool createTables();
-    void loadStadiumMap();
+    bool loadStadiumMap();  // replaces the map only if the reload succeeds
     void insertInitialData();
     void initializeSouvenirs();
     bool importFromCSV(const QStringList &filenames);
     bool importSingleCSV(const QString &filename);
+    QSet<QString> teamNames() const;
     bool insertTeam(const QString &teamName, const QString &stadiumName,
                     int capacity, const QString &location, const QString &surface,
                     const QString &league, const QString &dateOpened,
                     int centerField, const QString &typology, const QString &roof);
 
     QSqlQuery getTeamInfo(const QString &teamName);
+    QSqlQuery getAllTeamInfo();  // getTeamInfo() for every team, by team name
     QSqlQuery getAllTeamsSortedByTeamName();
     QSqlQuery getAllTeamsSortedByStadiumName();
     QSqlQuery getAmericanLeagueTeams();
@@ -41,10 +68,46 @@ public:
     QSqlQuery getTeamsWithGreatestCenterField();
     QSqlQuery getTeamsWithSmallestCenterField();
 
+    // The read-only listings above, copied out. Team listings come from the
+    // TeamCatalog once loadStadiumMap() has filled it; the rest are cached
+    // until a write to a table they read. teamName is only used by TeamInfo
+    // and TeamSouvenirs.
+    enum class Listing {
+        TeamInfo,
+        TeamsByTeamName,
+        TeamsByStadiumName,
+        AmericanLeagueTeams,
+        NationalLeagueTeams,
+        TeamsByTypology,
+        OpenRoofTeams,
+        TeamsByDateOpened,
+        TeamsByCapacity,
+        GreatestCenterField,
+        SmallestCenterField,
+        TeamSouvenirs
+    };
+    QueryResult cachedListing(Listing listing, const QString &teamName = QString());
+    // Each write here calls this as it runs, which covers autocommit writes.
+    // A caller that wraps writes in its own transaction must call it again
+    // after committing, since a reader may re-cache the old rows meanwhile
+    void invalidateCache(QueryCache::Tables tables) { cache->invalidate(tables); }
+    QSharedPointer<QueryCache> queryCache() const { return cache; }
+    // Any combination of attribute values and ranges, answered from the
+    // catalog's bitmaps; see TeamCatalog::filter() for the columns
+    QueryResult filterTeams(const TeamFilter &conditions);
+    // Rebuilt by loadStadiumMap(); writers that bypass it upsert after commit
+    QSharedPointer<TeamCatalog> teamCatalog() const { return catalog; }
+
+    // A team's souvenirs are the shared catalog plus its own rows; the writes
+    // below only touch that team's rows
     QVector<QPair<QString, double>> getSouvenirs(const QString &teamName);
+    QSqlQuery getTeamSouvenirs(const QString &teamName);  // item_name, price
     bool addSouvenir(const QString &teamName, const QString &itemName, double price);
     bool updateSouvenirPrice(const QString &teamName, const QString &itemName, double newPrice);
     bool deleteSouvenir(const QString &teamName, const QString &itemName);
+    // Price of a catalog item for every team without a price of its own
+    bool updateCatalogPrice(const QString &itemName, double newPrice);
+    QString lastError() const { return error; }  // of the last failed souvenir or team write
     bool updateSouvenirInMap(const QString &teamName, const QString &itemName, double newPrice);
 
     StadiumInfo getStadiumInfo(const QString &teamName) const;
@@ -53,18 +116,54 @@ public:
     bool validateAdmin(const QString &username, const QString &password);
 
     QSqlDatabase& database() { return db; }
-    void reloadStadiumData() { loadStadiumMap(); }
+    DatabaseService* async() const { return service; }  // set by initialize()
+    bool reloadStadiumData() { return loadStadiumMap(); }
+    const StadiumLoadStats& lastLoadStats() const { return lastLoad; }
 
     const HashMap<QString, StadiumInfo>& getStadiumMap() const { return stadiumMap; }
+    // Team <-> stadium names of the current map, kept in step by loadStadiumMap()
+    const TeamStadiumIndex& getTeamIndex() const { return teamIndex; }
 
     void refreshStadiumLists();
 
     bool importDistancesFromCSV(const QString &filename);
     QVector<QPair<QString, QPair<QString, double>>> getAllDistances() const;
+    // For writers outside this class (the import pipeline), once committed
+    void notifyDistancesChanged() { emit distancesChanged(); }
+
+signals:
+    // Emitted on the GUI thread once the stadium map has been patched. Writes
+    // through async() arrive here as deltas; loadStadiumMap() replaces
+    // everything and only sends stadiumMapReloaded().
+    void teamUpserted(const QString &teamName);
+    void souvenirAdded(const QString &teamName, const QString &itemName, double price);
+    void souvenirUpdated(const QString &teamName, const QString &itemName, double price);
+    void souvenirRemoved(const QString &teamName, const QString &itemName);
+    void catalogPriceUpdated(const QString &itemName, double price);  // before the per-team souvenirUpdated()
+    void distancesChanged();
+    void stadiumMapReloaded();
 
 private:
+    // Patch stadiumMap and teamIndex from the service's committed writes
+    void applyTeamsSaved(const QVector<TeamRecord> &teams);
+    void applySouvenirAdded(const QString &teamName, const QString &itemName, double price);
+    void applySouvenirUpdated(const QString &teamName, const QString &itemName, double price);
+    void applySouvenirRemoved(const QString &teamName, const QString &itemName);
+    void applyCatalogPriceUpdated(const QString &itemName, double price);
+
+    // How the team currently sells the item; false if the team doesn't exist
+    bool souvenirState(const QString &teamName, const QString &itemName,
+                       int &teamId, bool &catalogItem, bool &sold);
+
     QSqlDatabase db;
     HashMap<QString, StadiumInfo> stadiumMap;
+    TeamStadiumIndex teamIndex;
+    QSharedPointer<SouvenirCatalog> souvenirCatalog;  // referenced by every map entry
+    StadiumLoadStats lastLoad;
+    QString error;
+    DatabaseService* service = nullptr;
+    QSharedPointer<QueryCache> cache;
+    QSharedPointer<TeamCatalog> catalog;
 };
 
 #endif // DATABASE_H 
\ No newline at end of file
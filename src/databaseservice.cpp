@@ -0,0 +1,215 @@
+#include "databaseservice.h"
+#include <QSqlError>
+#include <QThread>
+#include <QDebug>
+
+DatabaseService::DatabaseService(const QString &databaseName, const QSharedPointer<QueryCache> &cache,
+                                 const QSharedPointer<TeamCatalog> &catalog, QObject *parent)
+    : QObject(parent)
+    , databaseName(databaseName)
+    , cache(cache)
+    , catalog(catalog)
+{
+    // SQLite serializes writers anyway; a single thread also keeps them in order
+    writer.setMaxThreadCount(1);
+    readers.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 4));
+}
+
+DatabaseService::~DatabaseService()
+{
+    readers.waitForDone();
+    writer.waitForDone();
+}
+
+Database* DatabaseService::connection(bool writable)
+{
+    if (!connections.hasLocalData()) {
+        // Deleted by QThreadStorage when the pool thread exits, on that thread
+        const QString name = QString("service-%1-%2")
+                                 .arg(quintptr(this), 0, 16)
+                                 .arg(quintptr(QThread::currentThreadId()), 0, 16);
+        Database* database = new Database(databaseName, name, !writable, cache, catalog);
+        database->open();
+        connections.setLocalData(database);
+    }
+    return connections.localData();
+}
+
+QFuture<QueryResult> DatabaseService::listing(Database::Listing listing, const QString &teamName)
+{
+    return read([listing, teamName](Database &database) {
+        return database.cachedListing(listing, teamName);
+    });
+}
+
+QFuture<QueryResult> DatabaseService::getTeamInfo(const QString &teamName)
+{
+    return listing(Database::Listing::TeamInfo, teamName);
+}
+
+QFuture<QueryResult> DatabaseService::getAllTeamsSortedByTeamName()
+{
+    return listing(Database::Listing::TeamsByTeamName);
+}
+
+QFuture<QueryResult> DatabaseService::getAllTeamsSortedByStadiumName()
+{
+    return listing(Database::Listing::TeamsByStadiumName);
+}
+
+QFuture<QueryResult> DatabaseService::getAmericanLeagueTeams()
+{
+    return listing(Database::Listing::AmericanLeagueTeams);
+}
+
+QFuture<QueryResult> DatabaseService::getNationalLeagueTeams()
+{
+    return listing(Database::Listing::NationalLeagueTeams);
+}
+
+QFuture<QueryResult> DatabaseService::getTeamsByTypology()
+{
+    return listing(Database::Listing::TeamsByTypology);
+}
+
+QFuture<QueryResult> DatabaseService::getOpenRoofTeams()
+{
+    return listing(Database::Listing::OpenRoofTeams);
+}
+
+QFuture<QueryResult> DatabaseService::getTeamsByDateOpened()
+{
+    return listing(Database::Listing::TeamsByDateOpened);
+}
+
+QFuture<QueryResult> DatabaseService::getTeamsByCapacity()
+{
+    return listing(Database::Listing::TeamsByCapacity);
+}
+
+QFuture<QueryResult> DatabaseService::getTeamsWithGreatestCenterField()
+{
+    return listing(Database::Listing::GreatestCenterField);
+}
+
+QFuture<QueryResult> DatabaseService::getTeamsWithSmallestCenterField()
+{
+    return listing(Database::Listing::SmallestCenterField);
+}
+
+QFuture<QueryResult> DatabaseService::getTeamSouvenirs(const QString &teamName)
+{
+    return listing(Database::Listing::TeamSouvenirs, teamName);
+}
+
+QFuture<QueryResult> DatabaseService::filterTeams(const TeamFilter &conditions)
+{
+    return read([conditions](Database &database) {
+        return database.filterTeams(conditions);
+    });
+}
+
+QFuture<QVector<QPair<QString, double>>> DatabaseService::getSouvenirs(const QString &teamName)
+{
+    return read([teamName](Database &database) {
+        return database.getSouvenirs(teamName);
+    });
+}
+
+QFuture<QSet<QString>> DatabaseService::teamNames()
+{
+    return read([](Database &database) {
+        return database.teamNames();
+    });
+}
+
+QFuture<QVector<QPair<QString, QPair<QString, double>>>> DatabaseService::getAllDistances()
+{
+    return read([](Database &database) {
+        return database.getAllDistances();
+    });
+}
+
+QFuture<QueryResult> DatabaseService::addSouvenir(const QString &teamName, const QString &itemName, double price)
+{
+    return write([this, teamName, itemName, price](Database &database) {
+        QueryResult result;
+        if (!database.addSouvenir(teamName, itemName, price)) {
+            result.error = database.lastError();
+        } else {
+            emit souvenirAdded(teamName.trimmed(), itemName.trimmed(), price);
+        }
+        return result;
+    });
+}
+
+QFuture<QueryResult> DatabaseService::updateSouvenirPrice(const QString &teamName, const QString &itemName, double newPrice)
+{
+    return write([this, teamName, itemName, newPrice](Database &database) {
+        QueryResult result;
+        if (!database.updateSouvenirPrice(teamName, itemName, newPrice)) {
+            result.error = database.lastError();
+        } else {
+            emit souvenirUpdated(teamName.trimmed(), itemName.trimmed(), newPrice);
+        }
+        return result;
+    });
+}
+
+QFuture<QueryResult> DatabaseService::deleteSouvenir(const QString &teamName, const QString &itemName)
+{
+    return write([this, teamName, itemName](Database &database) {
+        QueryResult result;
+        if (!database.deleteSouvenir(teamName, itemName)) {
+            result.error = database.lastError();
+        } else {
+            emit souvenirRemoved(teamName.trimmed(), itemName.trimmed());
+        }
+        return result;
+    });
+}
+
+QFuture<QueryResult> DatabaseService::updateCatalogPrice(const QString &itemName, double newPrice)
+{
+    return write([this, itemName, newPrice](Database &database) {
+        QueryResult result;
+        if (!database.updateCatalogPrice(itemName, newPrice)) {
+            result.error = database.lastError();
+        } else {
+            emit catalogPriceUpdated(itemName.trimmed(), newPrice);
+        }
+        return result;
+    });
+}
+
+QFuture<QueryResult> DatabaseService::saveTeams(const QVector<TeamRecord> &teams)
+{
+    return write([this, teams](Database &database) {
+        QueryResult result;
+        QSqlDatabase &connection = database.database();
+        if (!connection.transaction()) {
+            result.error = connection.lastError().text();
+            return result;
+        }
+        for (const TeamRecord &team : teams) {
+            if (!database.insertTeam(team.teamName, team.stadiumName, team.capacity, team.location,
+                                     team.surface, team.league, team.dateOpened, team.centerField,
+                                     team.typology, team.roof)) {
+                result.error = database.lastError();
+                connection.rollback();
+                return result;
+            }
+        }
+        if (!connection.commit()) {
+            result.error = connection.lastError().text();
+            connection.rollback();
+            return result;
+        }
+        database.invalidateCache(QueryCache::Teams);
+        for (const TeamRecord &team : teams) {
+            database.teamCatalog()->upsert(team);
+        }
+        emit teamsSaved(teams);
+        return result;
+    });
+}
@@ -0,0 +1,91 @@
+#ifndef DATABASESERVICE_H
+#define DATABASESERVICE_H
+
+#include <QObject>
+#include <QFuture>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <QtConcurrent>
+#include <QVariant>
+#include <QVector>
+#include <type_traits>
+#include "database.h"
+#include "teamcsv.h"
+
+// Runs Database calls off the GUI thread. QSqlDatabase connections can't be
+// shared between threads, so every worker thread lazily opens its own
+// Database on a named connection to the same file: reads go to a small pool
+// of read-only connections, writes to a single writer thread, which keeps
+// them in submission order. Results come back as QFutures; chain GUI work
+// with future.then(widget, ...) so it runs on the GUI thread, and is dropped
+// if the widget is gone.
+//
+// Created by Database::initialize() once the schema is current.
+class DatabaseService : public QObject
+{
+    Q_OBJECT
+
+public:
+    DatabaseService(const QString &databaseName, const QSharedPointer<QueryCache> &cache,
+                    const QSharedPointer<TeamCatalog> &catalog, QObject *parent = nullptr);
+    ~DatabaseService();  // waits for queued jobs
+
+    // Runs job(Database&) on a reader / the writer thread
+    template<typename Job>
+    auto read(Job job) -> QFuture<std::invoke_result_t<Job, Database&>> {
+        return QtConcurrent::run(&readers, [this, job]() mutable { return job(*connection(false)); });
+    }
+    template<typename Job>
+    auto write(Job job) -> QFuture<std::invoke_result_t<Job, Database&>> {
+        return QtConcurrent::run(&writer, [this, job]() mutable { return job(*connection(true)); });
+    }
+
+    // Async counterparts of the Database queries. Team listings are served
+    // from the shared TeamCatalog, the others from the QueryCache when
+    // nothing they read has changed.
+    QFuture<QueryResult> getTeamInfo(const QString &teamName);
+    QFuture<QueryResult> getAllTeamsSortedByTeamName();
+    QFuture<QueryResult> getAllTeamsSortedByStadiumName();
+    QFuture<QueryResult> getAmericanLeagueTeams();
+    QFuture<QueryResult> getNationalLeagueTeams();
+    QFuture<QueryResult> getTeamsByTypology();
+    QFuture<QueryResult> getOpenRoofTeams();
+    QFuture<QueryResult> getTeamsByDateOpened();
+    QFuture<QueryResult> getTeamsByCapacity();
+    QFuture<QueryResult> getTeamsWithGreatestCenterField();
+    QFuture<QueryResult> getTeamsWithSmallestCenterField();
+    QFuture<QueryResult> getTeamSouvenirs(const QString &teamName);
+    QFuture<QueryResult> filterTeams(const TeamFilter &conditions);
+    QFuture<QVector<QPair<QString, double>>> getSouvenirs(const QString &teamName);
+    QFuture<QSet<QString>> teamNames();
+    QFuture<QVector<QPair<QString, QPair<QString, double>>>> getAllDistances();
+
+    QFuture<QueryResult> addSouvenir(const QString &teamName, const QString &itemName, double price);
+    QFuture<QueryResult> updateSouvenirPrice(const QString &teamName, const QString &itemName, double newPrice);
+    QFuture<QueryResult> deleteSouvenir(const QString &teamName, const QString &itemName);
+    QFuture<QueryResult> updateCatalogPrice(const QString &itemName, double newPrice);
+    // Upserts every team in one transaction; all or nothing
+    QFuture<QueryResult> saveTeams(const QVector<TeamRecord> &teams);
+
+signals:
+    // Emitted from the writer thread once the change is committed, with
+    // names trimmed as stored; Database turns them into its change signals
+    void teamsSaved(const QVector<TeamRecord> &teams);
+    void souvenirAdded(const QString &teamName, const QString &itemName, double price);
+    void souvenirUpdated(const QString &teamName, const QString &itemName, double price);
+    void souvenirRemoved(const QString &teamName, const QString &itemName);
+    void catalogPriceUpdated(const QString &itemName, double price);
+
+private:
+    Database* connection(bool writable);  // this thread's connection, opened on first use
+    QFuture<QueryResult> listing(Database::Listing listing, const QString &teamName = QString());
+
+    const QString databaseName;
+    const QSharedPointer<QueryCache> cache;  // shared with every worker connection
+    const QSharedPointer<TeamCatalog> catalog;
+    QThreadStorage<Database*> connections;  // destroyed after the pools have joined their threads
+    QThreadPool readers;
+    QThreadPool writer;
+};
+
+#endif // DATABASESERVICE_H
@@ -0,0 +1,55 @@
+#ifndef DISJOINTSET_H
+#define DISJOINTSET_H
+
+#include <QVector>
+#include <utility>
+
+// Union-find over 0 .. n-1 with path compression and union by rank
+class DisjointSet {
+public:
+    explicit DisjointSet(int n) : parent(n), rank(n, 0), sets(n) {
+        for (int i = 0; i < n; ++i) {
+            parent[i] = i;
+        }
+    }
+
+    int find(int x) {
+        int root = x;
+        while (parent[root] != root) {
+            root = parent[root];
+        }
+        while (parent[x] != root) {
+            int next = parent[x];
+            parent[x] = root;
+            x = next;
+        }
+        return root;
+    }
+
+    // Merges the sets holding a and b; false if they were already one set
+    bool unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return false;
+        }
+        if (rank[a] < rank[b]) {
+            std::swap(a, b);
+        }
+        parent[b] = a;
+        if (rank[a] == rank[b]) {
+            ++rank[a];
+        }
+        --sets;
+        return true;
+    }
+
+    int setCount() const { return sets; }
+
+private:
+    QVector<int> parent;
+    QVector<int> rank;
+    int sets;
+};
+
+#endif // DISJOINTSET_H
@@ -0,0 +1,118 @@
+#include "distancecsv.h"
+#include "csvreader.h"
+#include "stadiumnameindex.h"
+#include <QDebug>
+
+namespace {
+
+// Parsed rows of one chunk
+struct DistanceChunk {
+    QVector<DistanceRecord> records;
+    int errors = 0;
+};
+
+// Only the first few bad lines of each chunk are logged
+const int MaxLoggedErrors = 5;
+
+// Fills record from the raw columns; reason says why a row was rejected
+bool makeRecord(QStringView from, QStringView to, double miles, bool milesOk, bool normalizeNames,
+                DistanceRecord& record, const char*& reason) {
+    if (!milesOk || miles <= 0) {
+        reason = "has an invalid distance";
+        return false;
+    }
+    record.miles = miles;
+    if (normalizeNames) {
+        record.from = StadiumNameIndex::normalize(from);
+        record.to = StadiumNameIndex::normalize(to);
+    } else {
+        record.from = from.trimmed().toString();
+        record.to = to.trimmed().toString();
+    }
+    if (record.from.isEmpty() || record.to.isEmpty()) {
+        reason = "has an empty stadium name";
+        return false;
+    }
+    return true;
+}
+
+bool parseReaderRow(const CsvReader& rows, bool normalizeNames, DistanceRecord& record, DistanceChunk& chunk) {
+    const char* reason = "has insufficient fields";
+    bool ok = false;
+    if (rows.fieldCount() >= 3) {
+        const double miles = rows.number(2, &ok);
+        ok = makeRecord(QString::fromUtf8(rows.field(0)), QString::fromUtf8(rows.field(1)),
+                        miles, ok, normalizeNames, record, reason);
+    }
+    if (!ok && ++chunk.errors <= MaxLoggedErrors) {
+        qDebug() << "Distance CSV line" << rows.lineNumber() << reason;
+    }
+    return ok;
+}
+
+} // namespace
+
+bool DistanceCsv::read(const QString& filename, bool normalizeNames,
+                       QVector<DistanceRecord>& records, int* errorCount) {
+    records.clear();
+    if (errorCount) {
+        *errorCount = 0;
+    }
+    CsvReader reader(filename);
+    if (!reader.open()) {
+        qDebug() << "Error opening distances file:" << filename << reader.errorString();
+        return false;
+    }
+
+    // The first row is a header unless its third column is already a distance
+    DistanceChunk first;
+    if (reader.readRow()) {
+        bool numeric = false;
+        reader.number(2, &numeric);
+        DistanceRecord record;
+        if (numeric && parseReaderRow(reader, normalizeNames, record, first)) {
+            first.records.append(record);
+        }
+    }
+
+    const QVector<CsvReader::Range> ranges = reader.split();
+    QVector<DistanceChunk> chunks(ranges.size());
+    reader.parallelFor(ranges, [&](int c, CsvReader& rows) {
+        DistanceChunk& chunk = chunks[c];
+        DistanceRecord record;
+        while (rows.readRow()) {
+            if (parseReaderRow(rows, normalizeNames, record, chunk)) {
+                chunk.records.append(record);
+            }
+        }
+    });
+
+    // Stitch the chunks back together in file order
+    int total = first.records.size();
+    int errors = first.errors;
+    for (const DistanceChunk& chunk : chunks) {
+        total += chunk.records.size();
+        errors += chunk.errors;
+    }
+    records.reserve(total);
+    records += first.records;
+    for (const DistanceChunk& chunk : chunks) {
+        records += chunk.records;
+    }
+    if (errorCount) {
+        *errorCount = errors;
+    }
+    qDebug() << "Read" << records.size() << "distances from" << filename << "in"
+             << ranges.size() << "chunks," << errors << "rows skipped";
+    return true;
+}
+
+bool DistanceCsv::parseRow(const QStringList& fields, bool normalizeNames, DistanceRecord& record) {
+    if (fields.size() < 3) {
+        return false;
+    }
+    bool ok = false;
+    const double miles = fields[2].trimmed().toDouble(&ok);
+    const char* reason = nullptr;
+    return makeRecord(fields[0], fields[1], miles, ok, normalizeNames, record, reason);
+}
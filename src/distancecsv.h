@@ -0,0 +1,31 @@
+#ifndef DISTANCECSV_H
+#define DISTANCECSV_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// One "from,to,miles" row of a distance CSV
+struct DistanceRecord {
+    QString from;
+    QString to;
+    double miles;
+};
+
+// Reads a distance CSV (optional header row) with the rows parsed and
+// validated in parallel chunks. Records come back in file order, so merging
+// them is deterministic whatever the thread count.
+class DistanceCsv {
+public:
+    // With normalizeNames set, from/to are StadiumNameIndex::normalize()d (the
+    // graph wants that, and it is the expensive part); otherwise just trimmed.
+    // Rows with missing names or a non-positive distance are skipped and counted
+    // in errorCount. Returns false only if the file can't be read.
+    static bool read(const QString& filename, bool normalizeNames,
+                     QVector<DistanceRecord>& records, int* errorCount = nullptr);
+
+    // Same validation for a single row that is already split into fields
+    static bool parseRow(const QStringList& fields, bool normalizeNames, DistanceRecord& record);
+};
+
+#endif // DISTANCECSV_H
@@ -0,0 +1,28 @@
+#include "distancematrix.h"
+#include "csrgraph.h"
+#include "searchworkspace.h"
+
+DistanceMatrix::DistanceMatrix(const CsrGraph& graph)
+    : n(graph.nodeCount()), dist(n * n), next(n * n, -1) {
+    // Edges are undirected, so the shortest-path tree rooted at "to" gives, for
+    // every other stadium, both its distance to "to" and its first hop toward it
+    for (int to = 0; to < n; ++to) {
+        const SearchWorkspace& search = shortestPathTree(graph, to);
+        for (int from = 0; from < n; ++from) {
+            dist[from * n + to] = search.distance(from);
+            next[from * n + to] = search.previous(from);
+        }
+    }
+}
+
+QVector<int> DistanceMatrix::path(int from, int to) const {
+    QVector<int> ids;
+    if (!reachable(from, to)) {
+        return ids;
+    }
+    ids.append(from);
+    for (int v = from; v != to; v = nextHop(v, to)) {
+        ids.append(nextHop(v, to));
+    }
+    return ids;
+}
@@ -0,0 +1,31 @@
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+#include <QVector>
+
+class CsrGraph;
+
+// All-pairs shortest distances over dense stadium IDs, stored row-major in one
+// contiguous array, plus a next-hop matrix so a full path can be expanded in
+// time linear in its length. Built once per graph version and then read-only.
+class DistanceMatrix {
+public:
+    explicit DistanceMatrix(const CsrGraph& graph);
+
+    int nodeCount() const { return n; }
+    // Shortest distance, or infinity if to is unreachable from from
+    double distance(int from, int to) const { return dist[from * n + to]; }
+    // First stadium after from on a shortest path to to, or -1 if unreachable
+    int nextHop(int from, int to) const { return next[from * n + to]; }
+    bool reachable(int from, int to) const { return from == to || nextHop(from, to) >= 0; }
+
+    // Stadium IDs from from to to inclusive; empty if there is no path
+    QVector<int> path(int from, int to) const;
+
+private:
+    int n;
+    QVector<double> dist;
+    QVector<int> next;
+};
+
+#endif // DISTANCEMATRIX_H
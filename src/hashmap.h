@@ -3,127 +3,294 @@
 
 #include <QString>
 #include <QVector>
-#include <functional>
+#include <QHash>
+#include <utility>
 #include "stadiuminfo.h"
 
-// Node structure for hash table
-template<typename K, typename V>
-struct HashNode {
-    K key;
-    V value;
-    HashNode* next;
-    
-    HashNode(const K& k, const V& v) : key(k), value(v), next(nullptr) {}
-};
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HASHMAP_USE_SSE2
+#endif
 
-// Custom HashMap implementation
+// Custom HashMap implementation: open addressing with Swiss-table style control
+// bytes. Each slot has one control byte (empty, deleted, or the low 7 bits of
+// its key's hash); probing compares a whole group of 16 control bytes at once
+// (SSE2 when available) and only touches keys whose 7-bit tag matches. The
+// table doubles once 7/8 of the slots are used.
+//
+// Reads don't have to copy: find() returns a pointer into the table (valid
+// until the next insert or remove), QString-keyed maps can be searched with a
+// QStringView, and range-for visits the live entries in place.
 template<typename K, typename V>
 class HashMap {
 private:
-    static const int TABLE_SIZE = 50;  // Fixed size for simplicity
-    HashNode<K, V>* table[TABLE_SIZE];
-    
-    // Hash function for QString keys
-    int hash(const QString& key) const {
-        int hash = 0;
-        for(QChar c : key) {
-            hash = (hash * 31 + c.unicode()) % TABLE_SIZE;
+    static constexpr int GROUP_SIZE = 16;
+    static constexpr signed char EMPTY = -128;   // 0b10000000
+    static constexpr signed char DELETED = -2;   // 0b11111110; full slots are 0..127
+
+public:
+    struct Slot {
+        K key;
+        V value;
+    };
+
+private:
+    QVector<signed char> ctrl;  // one control byte per slot
+    QVector<Slot> cells;
+    int count = 0;              // live entries
+    int growthLeft = 0;         // inserts left before the next resize (tombstones count as used)
+
+    // qHash is the identity for integers, so mix the bits: the high bits pick
+    // the group and the low 7 bits become the tag
+    // Any key type L that hashes and compares like K (e.g. QStringView for QString)
+    template<typename L>
+    static size_t hash(const L& key) {
+        quint64 h = quint64(qHash(key, 0));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return size_t(h);
+    }
+
+    static signed char tag(size_t h) {
+        return static_cast<signed char>(h & 0x7F);
+    }
+
+    // Bit i is set where byte i of the group equals value
+    static unsigned match(const signed char* group, signed char value) {
+#ifdef HASHMAP_USE_SSE2
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+#else
+        unsigned bits = 0;
+        for (int i = 0; i < GROUP_SIZE; ++i) {
+            if (group[i] == value) bits |= 1u << i;
         }
-        return hash;
+        return bits;
+#endif
     }
-    
-    // Hash function for int keys
-    int hash(const int& key) const {
-        return key % TABLE_SIZE;
+
+    // Bit i is set where slot i of the group is empty or deleted (high bit set)
+    static unsigned matchFree(const signed char* group) {
+#ifdef HASHMAP_USE_SSE2
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return unsigned(_mm_movemask_epi8(bytes));
+#else
+        unsigned bits = 0;
+        for (int i = 0; i < GROUP_SIZE; ++i) {
+            if (group[i] < 0) bits |= 1u << i;
+        }
+        return bits;
+#endif
     }
 
-public:
-    HashMap() {
-        for(int i = 0; i < TABLE_SIZE; i++) {
-            table[i] = nullptr;
+    static int lowestBit(unsigned bits) {
+        int i = 0;
+        while (!(bits & 1u)) {
+            bits >>= 1;
+            ++i;
+        }
+        return i;
+    }
+
+    int groupCount() const { return ctrl.size() / GROUP_SIZE; }
+
+    // Slot holding key, or -1
+    template<typename L>
+    int findSlot(const L& key) const {
+        if (ctrl.isEmpty()) {
+            return -1;
+        }
+        const size_t h = hash(key);
+        const signed char t = tag(h);
+        const int mask = groupCount() - 1;
+        int g = int((h >> 7) & size_t(mask));
+        // Triangular probing over groups visits every group once
+        for (int step = 1; step <= groupCount(); ++step) {
+            const signed char* group = ctrl.constData() + g * GROUP_SIZE;
+            for (unsigned bits = match(group, t); bits; bits &= bits - 1) {
+                int slot = g * GROUP_SIZE + lowestBit(bits);
+                if (cells[slot].key == key) {
+                    return slot;
+                }
+            }
+            if (match(group, EMPTY)) {
+                return -1;
+            }
+            g = (g + step) & mask;
+        }
+        return -1;
+    }
+
+    // First empty or deleted slot on key's probe sequence
+    int findFree(size_t h) const {
+        const int mask = groupCount() - 1;
+        int g = int((h >> 7) & size_t(mask));
+        for (int step = 1;; ++step) {
+            unsigned bits = matchFree(ctrl.constData() + g * GROUP_SIZE);
+            if (bits) {
+                return g * GROUP_SIZE + lowestBit(bits);
+            }
+            g = (g + step) & mask;
         }
     }
-    
-    ~HashMap() {
-        clear();
+
+    void rehash(int slotCount) {
+        QVector<signed char> oldCtrl = std::move(ctrl);
+        QVector<Slot> oldCells = std::move(cells);
+        ctrl = QVector<signed char>(slotCount, EMPTY);
+        cells = QVector<Slot>(slotCount);
+        growthLeft = slotCount - slotCount / 8 - count;
+        for (int i = 0; i < oldCtrl.size(); ++i) {
+            if (oldCtrl[i] >= 0) {
+                const size_t h = hash(oldCells[i].key);
+                int slot = findFree(h);
+                ctrl[slot] = tag(h);
+                cells[slot] = std::move(oldCells[i]);
+            }
+        }
     }
-    
+
+public:
+    HashMap() = default;
+
+    HashMap(HashMap&& other) noexcept { swap(other); }
+
+    HashMap& operator=(HashMap&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    HashMap(const HashMap&) = default;
+    HashMap& operator=(const HashMap&) = default;
+
+    void swap(HashMap& other) noexcept {
+        ctrl.swap(other.ctrl);
+        cells.swap(other.cells);
+        std::swap(count, other.count);
+        std::swap(growthLeft, other.growthLeft);
+    }
+
     void insert(const K& key, const V& value) {
-        int index = hash(key);
-        HashNode<K, V>* node = table[index];
-        
-        // Check if key already exists
-        while(node != nullptr) {
-            if(node->key == key) {
-                node->value = value;  // Update value if key exists
-                return;
+        int slot = findSlot(key);
+        if (slot >= 0) {
+            cells[slot].value = value;  // Update value if key exists
+            return;
+        }
+        if (growthLeft <= 0) {
+            // Grow, unless most of the used space is only tombstones
+            int slotCount = ctrl.isEmpty() ? GROUP_SIZE : ctrl.size();
+            if (count + 1 > (slotCount - slotCount / 8) / 2) {
+                slotCount *= 2;
             }
-            node = node->next;
+            rehash(slotCount);
+        }
+        const size_t h = hash(key);
+        slot = findFree(h);
+        if (ctrl[slot] == EMPTY) {
+            --growthLeft;
         }
-        
-        // Create new node
-        HashNode<K, V>* newNode = new HashNode<K, V>(key, value);
-        newNode->next = table[index];
-        table[index] = newNode;
+        ctrl[slot] = tag(h);
+        cells[slot].key = key;
+        cells[slot].value = value;
+        ++count;
     }
-    
+
     bool get(const K& key, V& value) const {
-        int index = hash(key);
-        HashNode<K, V>* node = table[index];
-        
-        while(node != nullptr) {
-            if(node->key == key) {
-                value = node->value;
-                return true;
-            }
-            node = node->next;
+        int slot = findSlot(key);
+        if (slot < 0) {
+            return false;
         }
-        return false;
+        value = cells[slot].value;
+        return true;
+    }
+
+    // Pointer to key's value, or nullptr; invalidated by insert() and remove()
+    const V* find(const K& key) const {
+        int slot = findSlot(key);
+        return slot >= 0 ? &cells[slot].value : nullptr;
+    }
+
+    V* find(const K& key) {
+        int slot = findSlot(key);
+        return slot >= 0 ? &cells[slot].value : nullptr;
+    }
+
+    // Lookup without building a QString (QString keys only; Qt hashes both alike)
+    const V* find(QStringView key) const {
+        int slot = findSlot(key);
+        return slot >= 0 ? &cells[slot].value : nullptr;
     }
-    
+
+    bool contains(const K& key) const {
+        return findSlot(key) >= 0;
+    }
+
     void remove(const K& key) {
-        int index = hash(key);
-        HashNode<K, V>* node = table[index];
-        HashNode<K, V>* prev = nullptr;
-        
-        while(node != nullptr) {
-            if(node->key == key) {
-                if(prev == nullptr) {
-                    table[index] = node->next;
-                } else {
-                    prev->next = node->next;
-                }
-                delete node;
-                return;
-            }
-            prev = node;
-            node = node->next;
+        int slot = findSlot(key);
+        if (slot < 0) {
+            return;
+        }
+        // A slot in a group that was never full can go straight back to empty,
+        // since no probe sequence ever continued past that group
+        const int g = slot / GROUP_SIZE;
+        const bool groupHasEmpty = match(ctrl.constData() + g * GROUP_SIZE, EMPTY) != 0;
+        ctrl[slot] = groupHasEmpty ? EMPTY : DELETED;
+        if (groupHasEmpty) {
+            ++growthLeft;
         }
+        cells[slot] = Slot();
+        --count;
     }
-    
+
     void clear() {
-        for(int i = 0; i < TABLE_SIZE; i++) {
-            HashNode<K, V>* node = table[i];
-            while(node != nullptr) {
-                HashNode<K, V>* temp = node;
-                node = node->next;
-                delete temp;
+        ctrl.clear();
+        cells.clear();
+        count = 0;
+        growthLeft = 0;
+    }
+
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+
+    // Read-only iteration over live entries (slot.key, slot.value), in table order
+    class const_iterator {
+    public:
+        const_iterator(const HashMap* map, int slot) : map(map), slot(slot) { skipFree(); }
+        const Slot& operator*() const { return map->cells[slot]; }
+        const Slot* operator->() const { return &map->cells[slot]; }
+        const_iterator& operator++() {
+            ++slot;
+            skipFree();
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return slot == other.slot; }
+        bool operator!=(const const_iterator& other) const { return slot != other.slot; }
+
+    private:
+        void skipFree() {
+            while (slot < map->ctrl.size() && map->ctrl[slot] < 0) {
+                ++slot;
             }
-            table[i] = nullptr;
         }
-    }
-    
+        const HashMap* map;
+        int slot;
+    };
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, int(ctrl.size())); }
+
+    // Deep copy of every entry; prefer iterating the map directly
     QVector<QPair<K, V>> getAllEntries() const {
         QVector<QPair<K, V>> entries;
-        for(int i = 0; i < TABLE_SIZE; i++) {
-            HashNode<K, V>* node = table[i];
-            while(node != nullptr) {
-                entries.append(qMakePair(node->key, node->value));
-                node = node->next;
+        entries.reserve(count);
+        for (int i = 0; i < ctrl.size(); ++i) {
+            if (ctrl[i] >= 0) {
+                entries.append(qMakePair(cells[i].key, cells[i].value));
             }
         }
         return entries;
     }
 };
 
-#endif // HASHMAP_H 
\ No newline at end of file
+#endif // HASHMAP_H
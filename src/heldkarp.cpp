@@ -0,0 +1,140 @@
+#include "heldkarp.h"
+#include <QtConcurrent>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// A subset always contains its end stop j, so bit j is dropped from the index:
+// the table for each end stop has 2^(k-1) entries instead of 2^k
+inline quint32 dropBit(quint32 mask, int j) {
+    return ((mask >> (j + 1)) << j) | (mask & ((1u << j) - 1));
+}
+
+struct LayerChunk {
+    int begin;
+    int end;
+};
+
+} // namespace
+
+double HeldKarpSolver::solve(const QVector<double>& dist, int k, QVector<int>& order) {
+    order.clear();
+    if (k <= 0 || k > MaxStops || dist.size() < k * k) {
+        return -1.0;
+    }
+    if (k == 1) {
+        order.append(0);
+        return 0.0;
+    }
+
+    const float inf = std::numeric_limits<float>::infinity();
+    QVector<float> d(k * k);
+    for (int i = 0; i < k * k; ++i) {
+        d[i] = dist[i] < 0 ? inf : float(dist[i]);
+    }
+
+    const quint32 full = (1u << k) - 1;
+    const qsizetype half = qsizetype(1) << (k - 1);
+    QVector<float> table(half * k, inf);
+    auto cost = [&](int j, quint32 mask) -> float& {
+        return table[j * half + dropBit(mask, j)];
+    };
+
+    // Visit subsets layer by layer (by size): every subset in a layer only
+    // reads the previous one, so a layer can be split across threads
+    QVector<quint32> masks(qsizetype(full) + 1);
+    QVector<int> layerStart(k + 2, 0);
+    for (quint32 mask = 0; mask <= full; ++mask) {
+        ++layerStart[qPopulationCount(mask) + 1];
+    }
+    for (int size = 0; size <= k; ++size) {
+        layerStart[size + 1] += layerStart[size];
+    }
+    QVector<int> fill(layerStart.begin(), layerStart.end() - 1);
+    for (quint32 mask = 0; mask <= full; ++mask) {
+        masks[fill[qPopulationCount(mask)]++] = mask;
+    }
+
+    for (int j = 0; j < k; ++j) {
+        cost(j, 1u << j) = 0.0f;
+    }
+
+    auto relaxRange = [&](const LayerChunk& chunk) {
+        for (int m = chunk.begin; m < chunk.end; ++m) {
+            const quint32 mask = masks[m];
+            for (quint32 js = mask; js; js &= js - 1) {
+                const int j = qCountTrailingZeroBits(js);
+                const quint32 rest = mask ^ (1u << j);
+                float best = inf;
+                for (quint32 is = rest; is; is &= is - 1) {
+                    const int i = qCountTrailingZeroBits(is);
+                    float c = table[i * half + dropBit(rest, i)] + d[i * k + j];
+                    if (c < best) {
+                        best = c;
+                    }
+                }
+                table[j * half + dropBit(mask, j)] = best;
+            }
+        }
+    };
+
+    const int chunkSize = 4096;
+    for (int size = 2; size <= k; ++size) {
+        int begin = layerStart[size];
+        int end = layerStart[size + 1];
+        if (end - begin <= chunkSize) {
+            relaxRange({begin, end});
+            continue;
+        }
+        QVector<LayerChunk> chunks;
+        for (int c = begin; c < end; c += chunkSize) {
+            chunks.append({c, qMin(c + chunkSize, end)});
+        }
+        QtConcurrent::blockingMap(chunks, relaxRange);
+    }
+
+    int last = -1;
+    float best = inf;
+    for (int j = 0; j < k; ++j) {
+        if (cost(j, full) < best) {
+            best = cost(j, full);
+            last = j;
+        }
+    }
+    if (last < 0) {
+        return -1.0;
+    }
+
+    // Walk back from the best end stop, re-deriving each predecessor from the
+    // table instead of storing a parent for every state
+    quint32 mask = full;
+    int current = last;
+    order.append(current);
+    while (mask != (1u << current)) {
+        const quint32 rest = mask ^ (1u << current);
+        int prev = -1;
+        float prevBest = inf;
+        for (int i = 0; i < k; ++i) {
+            if (rest & (1u << i)) {
+                float c = cost(i, rest) + d[i * k + current];
+                if (c < prevBest) {
+                    prevBest = c;
+                    prev = i;
+                }
+            }
+        }
+        mask = rest;
+        current = prev;
+        order.append(current);
+    }
+    std::reverse(order.begin(), order.end());
+
+    // Report the length in double precision along the chosen order
+    double total = 0.0;
+    for (int i = 0; i + 1 < order.size(); ++i) {
+        total += dist[order[i] * k + order[i + 1]];
+    }
+    return total;
+}
@@ -0,0 +1,22 @@
+#ifndef HELDKARP_H
+#define HELDKARP_H
+
+#include <QVector>
+
+// Exact shortest open path through every stop (Held-Karp dynamic programming
+// over subsets). The start and end stops are free, matching the old
+// permutation search. Distances come from the shortest-path closure, so
+// any two reachable stops are directly comparable.
+class HeldKarpSolver {
+public:
+    // Largest stop count we solve exactly; the table holds k * 2^(k-1) floats
+    // (about 40 MB at 20 stops)
+    static const int MaxStops = 20;
+
+    // dist is a row-major k x k matrix, negative where there is no path.
+    // Fills order with stop indices and returns the length, or -1 if no
+    // ordering connects every stop (or k is out of range).
+    static double solve(const QVector<double>& dist, int k, QVector<int>& order);
+};
+
+#endif // HELDKARP_H
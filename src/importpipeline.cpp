@@ -0,0 +1,218 @@
+#include "importpipeline.h"
+#include "csvreader.h"
+#include "importwriter.h"
+#include "database.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QtConcurrent>
+#include <QDebug>
+
+ImportPipeline::ImportPipeline(Kind kind, const QStringList& filenames, const QString& databaseName,
+                               const QSharedPointer<QueryCache>& cache,
+                               const QSharedPointer<TeamCatalog>& catalog,
+                               const QSet<QString>& knownTeams, QObject* parent)
+    : QObject(parent)
+    , importKind(kind)
+    , filenames(filenames)
+    , databaseName(databaseName)
+    , cache(cache)
+    , catalog(catalog)
+    , knownTeams(knownTeams)
+{
+    pool.setMaxThreadCount(3);
+}
+
+ImportPipeline::~ImportPipeline()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+void ImportPipeline::start()
+{
+    if (running.exchange(true)) {
+        return;
+    }
+    timer.start();
+    QtConcurrent::run(&pool, [this]() { parseStage(); });
+    QtConcurrent::run(&pool, [this]() { validateStage(); });
+    QtConcurrent::run(&pool, [this]() { writeStage(); });
+}
+
+void ImportPipeline::cancel()
+{
+    cancelled = true;
+    rawRows.abort();
+    records.abort();
+}
+
+ImportProgress ImportPipeline::progress() const
+{
+    ImportProgress p;
+    p.rowsRead = rowsRead;
+    p.rowsWritten = rowsWritten;
+    p.errors = errors;
+    p.skipped = skipped;
+    p.elapsedMs = timer.isValid() ? timer.elapsed() : 0;
+    return p;
+}
+
+void ImportPipeline::fail(const QString& message)
+{
+    {
+        QMutexLocker locker(&failureMutex);
+        if (failure.isEmpty()) {
+            failure = message;
+        }
+    }
+    failed = true;
+    rawRows.abort();
+    records.abort();
+}
+
+void ImportPipeline::parseStage()
+{
+    for (const QString& filename : filenames) {
+        CsvReader reader(filename);
+        if (!reader.open()) {
+            fail(QString("Could not open %1: %2").arg(filename, reader.errorString()));
+            return;
+        }
+        // Skip header line
+        reader.readRow();
+
+        RawBatch batch;
+        while (reader.readRow()) {
+            QStringList fields;
+            fields.reserve(reader.fieldCount());
+            for (int i = 0; i < reader.fieldCount(); ++i) {
+                fields.append(reader.text(i));
+            }
+            batch.rows.append(fields);
+            batch.lines.append(reader.lineNumber());
+            if (batch.rows.size() == BatchRows) {
+                rowsRead += batch.rows.size();
+                if (!rawRows.push(std::move(batch))) {
+                    return;  // cancelled
+                }
+                batch = RawBatch();
+            }
+        }
+        if (!batch.rows.isEmpty()) {
+            rowsRead += batch.rows.size();
+            if (!rawRows.push(std::move(batch))) {
+                return;
+            }
+        }
+    }
+    rawRows.close();
+}
+
+void ImportPipeline::validateStage()
+{
+    RawBatch raw;
+    while (rawRows.pop(raw)) {
+        RecordBatch batch;
+        for (int i = 0; i < raw.rows.size(); ++i) {
+            bool ok = false;
+            if (importKind == Teams) {
+                TeamRecord team;
+                ok = TeamCsv::parseRow(raw.rows[i], team);
+                if (ok) {
+                    // Existing teams (or repeats within the import) are left alone
+                    if (knownTeams.contains(team.teamName)) {
+                        ++skipped;
+                        continue;
+                    }
+                    knownTeams.insert(team.teamName);
+                    batch.teams.append(team);
+                }
+            } else {
+                DistanceRecord distance;
+                ok = DistanceCsv::parseRow(raw.rows[i], false, distance);
+                if (ok) {
+                    batch.distances.append(distance);
+                }
+            }
+            if (!ok && ++errors <= 20) {
+                qDebug() << "Import: skipping invalid line" << raw.lines[i];
+            }
+        }
+        if (batch.size() > 0 && !records.push(std::move(batch))) {
+            return;  // cancelled
+        }
+    }
+    records.close();
+}
+
+void ImportPipeline::writeStage()
+{
+    const QString connectionName = QString("import-%1").arg(quintptr(this), 0, 16);
+    bool ok = false;
+    QString message;
+    QVector<TeamRecord> writtenTeams;  // applied to the catalog once committed
+    {
+        QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        connection.setDatabaseName(databaseName);
+        connection.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(Database::BusyTimeoutMs));
+        if (!connection.open()) {
+            fail("Could not open the database: " + connection.lastError().text());
+        } else if (!connection.transaction()) {
+            fail("Could not start a transaction: " + connection.lastError().text());
+        } else {
+            {
+                ImportWriter writer(connection);
+                RecordBatch batch;
+                while (records.pop(batch)) {
+                    const bool written = importKind == Teams ? writer.writeTeams(batch.teams)
+                                                             : writer.writeDistances(batch.distances);
+                    if (!written) {
+                        fail("Database error: " + writer.lastError());
+                        break;
+                    }
+                    rowsWritten += batch.size();
+                    if (catalog) {
+                        writtenTeams += batch.teams;
+                    }
+                }
+            }
+            if (!cancelled && !failed) {
+                ok = connection.commit();
+                if (!ok) {
+                    fail("Could not commit the import: " + connection.lastError().text());
+                } else {
+                    if (cache) {
+                        cache->invalidate(importKind == Teams ? QueryCache::Teams | QueryCache::Souvenirs
+                                                              : QueryCache::Tables(QueryCache::Distances));
+                    }
+                    for (const TeamRecord& team : writtenTeams) {
+                        catalog->upsert(team);
+                    }
+                }
+            }
+            if (!ok) {
+                connection.rollback();
+            }
+        }
+        connection.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (ok) {
+        message = QString("Imported %1 rows in %2 ms").arg(rowsWritten.load()).arg(timer.elapsed());
+        if (errors > 0) {
+            message += QString(" (%1 invalid rows skipped)").arg(errors.load());
+        }
+    } else if (failed) {
+        QMutexLocker locker(&failureMutex);
+        message = failure;
+    } else {
+        message = "Import cancelled; no changes were saved.";
+    }
+    qDebug() << "Import finished:" << message;
+
+    QMetaObject::invokeMethod(this, [this, ok, message]() {
+        running = false;
+        emit finished(ok, message);
+    }, Qt::QueuedConnection);
+}
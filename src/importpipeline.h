@@ -0,0 +1,106 @@
+#ifndef IMPORTPIPELINE_H
+#define IMPORTPIPELINE_H
+
+#include <QObject>
+#include <QStringList>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <atomic>
+#include "boundedqueue.h"
+#include "teamcsv.h"
+#include "distancecsv.h"
+#include "querycache.h"
+#include "teamcatalog.h"
+
+// Snapshot of a running import, polled by the progress view
+struct ImportProgress {
+    qint64 rowsRead = 0;
+    qint64 rowsWritten = 0;
+    int errors = 0;         // rows rejected by validation
+    int skipped = 0;        // teams that already exist
+    qint64 elapsedMs = 0;
+
+    double rowsPerSecond() const { return elapsedMs > 0 ? rowsWritten * 1000.0 / elapsedMs : 0.0; }
+};
+
+// Runs a CSV import off the GUI thread as three stages, each on its own worker:
+//   parse    - CsvReader rows -> batches of raw fields
+//   validate - TeamCsv / DistanceCsv cleaning -> batches of records
+//   write    - ImportWriter on a private connection, one transaction overall
+// The stages are linked by BoundedQueues, so a slow writer throttles the
+// parser instead of the whole file piling up in memory. cancel() aborts the
+// queues and the writer rolls back, leaving the database as it was.
+class ImportPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind { Teams, Distances };
+
+    // databaseName is the SQLite file the writer opens its own connection to;
+    // cache (optional) is invalidated and catalog (optional) gets the new
+    // teams once the import commits.
+    // Teams in knownTeams are skipped, like Database::importSingleCSV does.
+    ImportPipeline(Kind kind, const QStringList& filenames, const QString& databaseName,
+                   const QSharedPointer<QueryCache>& cache = QSharedPointer<QueryCache>(),
+                   const QSharedPointer<TeamCatalog>& catalog = QSharedPointer<TeamCatalog>(),
+                   const QSet<QString>& knownTeams = QSet<QString>(), QObject* parent = nullptr);
+    ~ImportPipeline();  // cancels and waits for the workers
+
+    void start();
+    void cancel();
+    bool isRunning() const { return running; }
+    Kind kind() const { return importKind; }
+    ImportProgress progress() const;
+
+signals:
+    // Delivered on this object's thread once the writer is done. ok is false if
+    // the import failed or was cancelled; nothing was committed in that case.
+    void finished(bool ok, const QString& message);
+
+private:
+    struct RawBatch {
+        QVector<QStringList> rows;
+        QVector<int> lines;
+    };
+    struct RecordBatch {
+        QVector<TeamRecord> teams;
+        QVector<DistanceRecord> distances;
+        int size() const { return teams.size() + distances.size(); }
+    };
+
+    static const int BatchRows = 512;
+    static const int QueueBatches = 8;
+
+    void parseStage();
+    void validateStage();
+    void writeStage();
+    void fail(const QString& message);  // stops every stage; the writer rolls back
+
+    const Kind importKind;
+    const QStringList filenames;
+    const QString databaseName;
+    const QSharedPointer<QueryCache> cache;
+    const QSharedPointer<TeamCatalog> catalog;
+    QSet<QString> knownTeams;           // owned by the validate stage once started
+
+    BoundedQueue<RawBatch> rawRows{QueueBatches};
+    BoundedQueue<RecordBatch> records{QueueBatches};
+    QThreadPool pool;
+    QElapsedTimer timer;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> failed{false};
+    std::atomic<qint64> rowsRead{0};
+    std::atomic<qint64> rowsWritten{0};
+    std::atomic<int> errors{0};
+    std::atomic<int> skipped{0};
+    QMutex failureMutex;
+    QString failure;                    // first error message, guarded by failureMutex
+};
+
+#endif // IMPORTPIPELINE_H
@@ -0,0 +1,106 @@
+#include "importwriter.h"
+#include <QSqlError>
+#include <QVariant>
+#include <QDebug>
+
+ImportWriter::ImportWriter(const QSqlDatabase& connection)
+    : teamQuery(connection)
+    , stadiumQuery(connection)
+    , distanceQuery(connection)
+{
+}
+
+bool ImportWriter::prepare(QSqlQuery& query, bool& prepared, const QString& sql) {
+    if (!prepared) {
+        if (!query.prepare(sql)) {
+            error = query.lastError().text();
+            qDebug() << "Error preparing import statement:" << error;
+            return false;
+        }
+        prepared = true;
+    }
+    return true;
+}
+
+bool ImportWriter::execBatch(QSqlQuery& query, const char* what) {
+    if (!query.execBatch()) {
+        error = query.lastError().text();
+        qDebug() << "Error inserting" << what << ":" << error;
+        return false;
+    }
+    return true;
+}
+
+bool ImportWriter::writeTeams(const QVector<TeamRecord>& teams) {
+    if (teams.isEmpty()) {
+        return true;
+    }
+    if (!prepare(teamQuery, teamPrepared,
+                 "INSERT INTO teams (team_name, stadium_name, capacity, location, "
+                 "surface, league, date_opened, center_field, typology, roof) "
+                 "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+                 "ON CONFLICT(team_name) DO NOTHING")) {
+        return false;
+    }
+
+    QVariantList teamNames, stadiumNames, capacities, locations, surfaces, leagues,
+                 datesOpened, centerFields, typologies, roofs;
+    for (const TeamRecord& team : teams) {
+        teamNames.append(team.teamName);
+        stadiumNames.append(team.stadiumName);
+        capacities.append(team.capacity);
+        locations.append(team.location);
+        surfaces.append(team.surface);
+        leagues.append(team.league);
+        datesOpened.append(team.dateOpened);
+        centerFields.append(team.centerField);
+        typologies.append(team.typology);
+        roofs.append(team.roof);
+    }
+    teamQuery.bindValue(0, teamNames);
+    teamQuery.bindValue(1, stadiumNames);
+    teamQuery.bindValue(2, capacities);
+    teamQuery.bindValue(3, locations);
+    teamQuery.bindValue(4, surfaces);
+    teamQuery.bindValue(5, leagues);
+    teamQuery.bindValue(6, datesOpened);
+    teamQuery.bindValue(7, centerFields);
+    teamQuery.bindValue(8, typologies);
+    teamQuery.bindValue(9, roofs);
+    // New teams sell the shared souvenir catalog; no per-team rows needed
+    return execBatch(teamQuery, "teams");
+}
+
+bool ImportWriter::writeDistances(const QVector<DistanceRecord>& distances) {
+    if (distances.isEmpty()) {
+        return true;
+    }
+    // Endpoints are stored once in stadiums and referenced by id
+    if (!prepare(stadiumQuery, stadiumPrepared,
+                 "INSERT OR IGNORE INTO stadiums (name) VALUES (?)")
+        || !prepare(distanceQuery, distancePrepared,
+                    "INSERT OR REPLACE INTO distances (from_id, to_id, distance) VALUES ("
+                    "(SELECT stadium_id FROM stadiums WHERE name = ?), "
+                    "(SELECT stadium_id FROM stadiums WHERE name = ?), ?)")) {
+        return false;
+    }
+    QVariantList names, fromTeams, toTeams, miles;
+    names.reserve(distances.size() * 2);
+    fromTeams.reserve(distances.size());
+    toTeams.reserve(distances.size());
+    miles.reserve(distances.size());
+    for (const DistanceRecord& record : distances) {
+        fromTeams.append(record.from);
+        toTeams.append(record.to);
+        miles.append(record.miles);
+    }
+    names << fromTeams << toTeams;
+    stadiumQuery.bindValue(0, names);
+    if (!execBatch(stadiumQuery, "stadiums")) {
+        return false;
+    }
+    distanceQuery.bindValue(0, fromTeams);
+    distanceQuery.bindValue(1, toTeams);
+    distanceQuery.bindValue(2, miles);
+    return execBatch(distanceQuery, "distances");
+}
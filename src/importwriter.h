@@ -0,0 +1,41 @@
+#ifndef IMPORTWRITER_H
+#define IMPORTWRITER_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QVector>
+#include "teamcsv.h"
+#include "distancecsv.h"
+
+// Batched INSERTs for the CSV importers on one connection. Each statement is
+// prepared once, on first use, and every batch is bound column-wise through
+// execBatch. The caller owns the transaction.
+class ImportWriter {
+public:
+    explicit ImportWriter(const QSqlDatabase& connection);
+
+    // Inserts the teams, which sell the shared souvenir catalog without any
+    // rows of their own. Teams that already exist are left as they are
+    // (ON CONFLICT DO NOTHING).
+    bool writeTeams(const QVector<TeamRecord>& teams);
+    // Adds unseen endpoint names to stadiums, then INSERT OR REPLACE by id,
+    // so the last row for a pair wins
+    bool writeDistances(const QVector<DistanceRecord>& distances);
+
+    QString lastError() const { return error; }
+
+private:
+    bool prepare(QSqlQuery& query, bool& prepared, const QString& sql);
+    bool execBatch(QSqlQuery& query, const char* what);
+
+    QSqlQuery teamQuery;
+    QSqlQuery stadiumQuery;
+    QSqlQuery distanceQuery;
+    bool teamPrepared = false;
+    bool stadiumPrepared = false;
+    bool distancePrepared = false;
+    QString error;
+};
+
+#endif // IMPORTWRITER_H
@@ -2,6 +2,7 @@
 #include "ui_mainwindow.h"
 #include "adminlogindialog.h"
 #include "adminpanel.h"
+#include "teamfilterdialog.h"
 #include <QVBoxLayout>
 #include <QPushButton>
 #include <QComboBox>
@@ -9,6 +10,7 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QInputDialog>
+#include <QDebug>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -28,6 +30,24 @@ MainWindow::MainWindow(QWidget *parent)
     
     // Setup all button connections first
     setupConnections();
+
+    // Admin changes arrive as deltas; only a full reload repopulates everything
+    connect(db, &Database::teamUpserted, this, &MainWindow::applyTeamChange);
+    connect(db, &Database::souvenirAdded, this, [this](const QString &teamName, const QString &itemName, double price) {
+        applySouvenirChange(teamName, itemName, price, false);
+    });
+    connect(db, &Database::souvenirUpdated, this, [this](const QString &teamName, const QString &itemName, double price) {
+        applySouvenirChange(teamName, itemName, price, false);
+    });
+    connect(db, &Database::souvenirRemoved, this, [this](const QString &teamName, const QString &itemName) {
+        applySouvenirChange(teamName, itemName, 0.0, true);
+    });
+    connect(db, &Database::distancesChanged, this, [this]() {
+        if (stadiumGraph) {
+            stadiumGraph->loadFromDatabase(db);
+        }
+    });
+    connect(db, &Database::stadiumMapReloaded, this, &MainWindow::refreshData);
     
     // Populate the combo box with team names
     QSqlQuery query = db->getAllTeamsSortedByTeamName();
@@ -64,20 +84,38 @@ void MainWindow::setupConnections()
     connect(ui->capacityButton, &QPushButton::clicked, this, &MainWindow::displayTeamsByCapacity);
     connect(ui->maxCenterFieldButton, &QPushButton::clicked, this, &MainWindow::displayGreatestCenterField);
     connect(ui->minCenterFieldButton, &QPushButton::clicked, this, &MainWindow::displaySmallestCenterField);
+    connect(ui->filterTeamsButton, &QPushButton::clicked, this, &MainWindow::displayFilteredTeams);
     connect(ui->viewSouvenirsButton, &QPushButton::clicked, this, &MainWindow::viewTeamSouvenirs);
     connect(ui->resetDatabaseButton, &QPushButton::clicked, this, &MainWindow::on_resetDatabaseButton_clicked);
 }
 
 void MainWindow::clearResults()
 {
+    infoTeam.clear();
+    souvenirTeam.clear();
     ui->resultsTable->clear();
     ui->resultsTable->setRowCount(0);
     ui->resultsTable->setColumnCount(0);
 }
 
-void MainWindow::displayQueryResults(QSqlQuery &query, const QStringList &headers)
+void MainWindow::showQueryResults(QFuture<QueryResult> future, const QStringList &headers)
+{
+    // Only the latest request is shown; one that finishes after a newer
+    // click is dropped
+    const int request = ++latestRequest;
+    future.then(this, [this, request, headers](const QueryResult &result) {
+        if (request == latestRequest) {
+            displayQueryResults(result, headers);
+        }
+    });
+}
+
+void MainWindow::displayQueryResults(const QueryResult &result, const QStringList &headers)
 {
     clearResults();
+    if (!result.ok()) {
+        qDebug() << "Query failed:" << result.error;
+    }
     
     ui->resultsTable->setColumnCount(headers.size());
     ui->resultsTable->setHorizontalHeaderLabels(headers);
@@ -85,16 +123,14 @@ void MainWindow::displayQueryResults(QSqlQuery &query, const QStringList &header
     // Make the table read-only
     ui->resultsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     
-    int row = 0;
-    while (query.next()) {
-        ui->resultsTable->insertRow(row);
+    ui->resultsTable->setRowCount(result.rowCount());
+    for (int row = 0; row < result.rowCount(); ++row) {
         for (int col = 0; col < headers.size(); ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
+            QTableWidgetItem *item = new QTableWidgetItem(result.value(row, col).toString());
             // Make each item non-editable
             item->setFlags(item->flags() & ~Qt::ItemIsEditable);
             ui->resultsTable->setItem(row, col, item);
         }
-        row++;
     }
     
     ui->resultsTable->resizeColumnsToContents();
@@ -112,87 +148,82 @@ void MainWindow::displayQueryResults(QSqlQuery &query, const QStringList &header
 void MainWindow::displayTeamInfo()
 {
     QString teamName = ui->teamComboBox->currentText();
-    QSqlQuery query = db->getTeamInfo(teamName);
-    
     QStringList headers = {"Team Name", "Stadium", "Capacity", "Location", "Surface",
                          "League", "Opened", "Center Field", "Typology", "Roof"};
-    displayQueryResults(query, headers);
+    const int request = ++latestRequest;
+    db->async()->getTeamInfo(teamName).then(this, [this, request, headers, teamName](const QueryResult &result) {
+        if (request == latestRequest) {
+            displayQueryResults(result, headers);
+            infoTeam = teamName;
+        }
+    });
 }
 
 void MainWindow::displayAllTeamsByTeamName()
 {
-    QSqlQuery query = db->getAllTeamsSortedByTeamName();
     QStringList headers = {"Team Name", "Stadium"};
-    displayQueryResults(query, headers);
+    showQueryResults(db->async()->getAllTeamsSortedByTeamName(), headers);
 }
 
 void MainWindow::displayAllTeamsByStadiumName()
 {
-    QSqlQuery query = db->getAllTeamsSortedByStadiumName();
     QStringList headers = {"Team Name", "Stadium"};
-    displayQueryResults(query, headers);
+    showQueryResults(db->async()->getAllTeamsSortedByStadiumName(), headers);
 }
 
 void MainWindow::displayAmericanLeagueTeams()
 {
-    QSqlQuery query = db->getAmericanLeagueTeams();
     QStringList headers = {"Team Name", "Stadium"};
-    displayQueryResults(query, headers);
+    showQueryResults(db->async()->getAmericanLeagueTeams(), headers);
 }
 
 void MainWindow::displayNationalLeagueTeams()
 {
-    QSqlQuery query = db->getNationalLeagueTeams();
     QStringList headers = {"Team Name", "Stadium"};
-    displayQueryResults(query, headers);
+    showQueryResults(db->async()->getNationalLeagueTeams(), headers);
 }
 
 void MainWindow::displayTeamsByTypology()
 {
-    QSqlQuery query = db->getTeamsByTypology();
     QStringList headers = {"Stadium", "Team Name", "Typology"};
-    displayQueryResults(query, headers);
+    showQueryResults(db->async()->getTeamsByTypology(), headers);
 }
 
 void MainWindow::displayOpenRoofTeams()
 {
-    QSqlQuery query = db->getOpenRoofTeams();
     QStringList headers = {"Team Name"};
-    displayQueryResults(query, headers);
+    showQueryResults(db->async()->getOpenRoofTeams(), headers);
 }
 
 void MainWindow::displayTeamsByDateOpened()
 {
-    QSqlQuery query = db->getTeamsByDateOpened();
     QStringList headers = {"Stadium", "Team Name", "Date Opened"};
-    displayQueryResults(query, headers);
+    showQueryResults(db->async()->getTeamsByDateOpened(), headers);
 }
 
 void MainWindow::displayTeamsByCapacity()
 {
-    QSqlQuery query = db->getTeamsByCapacity();
     QStringList headers = {"Stadium", "Team Name", "Capacity"};
-    clearResults();
-    ui->resultsTable->setColumnCount(headers.size());
-    ui->resultsTable->setHorizontalHeaderLabels(headers);
-    ui->resultsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    const int request = ++latestRequest;
+    db->async()->getTeamsByCapacity().then(this, [this, request, headers](const QueryResult &result) {
+        if (request == latestRequest) {
+            displayQueryResults(result, headers);
+            appendCapacityTotal(result);
+        }
+    });
+}
 
-    int row = 0;
+void MainWindow::appendCapacityTotal(const QueryResult &result)
+{
     int totalCapacity = 0;
-    while (query.next()) {
-        ui->resultsTable->insertRow(row);
-        for (int col = 0; col < headers.size(); ++col) {
-            QTableWidgetItem *item = new QTableWidgetItem(query.value(col).toString());
-            item->setFlags(item->flags() & ~Qt::ItemIsEditable);
-            ui->resultsTable->setItem(row, col, item);
-        }
+    for (int row = 0; row < result.rowCount(); ++row) {
         // Sum the capacity (column 2)
         bool ok = false;
-        int cap = query.value(2).toInt(&ok);
+        int cap = result.value(row, 2).toInt(&ok);
         if (ok) totalCapacity += cap;
-        row++;
     }
     // Add summary row
+    const int row = ui->resultsTable->rowCount();
     ui->resultsTable->insertRow(row);
     QTableWidgetItem *totalLabel1 = new QTableWidgetItem("Total");
     totalLabel1->setFlags(totalLabel1->flags() & ~Qt::ItemIsEditable);
@@ -203,25 +234,30 @@ void MainWindow::displayTeamsByCapacity()
     ui->resultsTable->setItem(row, 0, totalLabel1);
     ui->resultsTable->setItem(row, 1, totalLabel2);
     ui->resultsTable->setItem(row, 2, totalValue);
-
     ui->resultsTable->resizeColumnsToContents();
-    ui->resultsTable->setDragDropMode(QAbstractItemView::NoDragDrop);
-    ui->resultsTable->verticalHeader()->setSectionsMovable(false);
-    ui->resultsTable->horizontalHeader()->setSectionsMovable(false);
 }
 
 void MainWindow::displayGreatestCenterField()
 {
-    QSqlQuery query = db->getTeamsWithGreatestCenterField();
     QStringList headers = {"Stadium", "Team Name", "Distance to Center"};
-    displayQueryResults(query, headers);
+    showQueryResults(db->async()->getTeamsWithGreatestCenterField(), headers);
 }
 
 void MainWindow::displaySmallestCenterField()
 {
-    QSqlQuery query = db->getTeamsWithSmallestCenterField();
     QStringList headers = {"Stadium", "Team Name", "Distance to Center"};
-    displayQueryResults(query, headers);
+    showQueryResults(db->async()->getTeamsWithSmallestCenterField(), headers);
+}
+
+void MainWindow::displayFilteredTeams()
+{
+    TeamFilterDialog dialog(*db->teamCatalog(), this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    QStringList headers = {"Team Name", "Stadium", "League", "Roof", "Surface", "Typology",
+                           "Capacity", "Center Field"};
+    showQueryResults(db->async()->filterTeams(dialog.filter()), headers);
 }
 
 void MainWindow::viewTeamSouvenirs()
@@ -232,19 +268,67 @@ void MainWindow::viewTeamSouvenirs()
         return;
     }
 
-    QSqlQuery query(db->database());
-    query.prepare("SELECT item_name, price FROM souvenirs WHERE team_name = :team");
-    query.bindValue(":team", selectedTeam);
+    QStringList headers;
+    headers << "Souvenir" << "Price ($)";
+    const int request = ++latestRequest;
+    db->async()->getTeamSouvenirs(selectedTeam).then(this, [this, request, headers, selectedTeam](const QueryResult &result) {
+        if (request != latestRequest) {
+            return;
+        }
+        if (result.ok()) {
+            displayQueryResults(result, headers);
+            souvenirTeam = selectedTeam;
+        } else {
+            QMessageBox::critical(this, "Error", "Failed to fetch souvenirs: " + result.error);
+        }
+    });
+}
 
-    if (query.exec()) {
-        QStringList headers;
-        headers << "Souvenir" << "Price ($)";
-        displayQueryResults(query, headers);
-    } else {
-        QMessageBox::critical(this, "Error", "Failed to fetch souvenirs: " + query.lastError().text());
+void MainWindow::applyTeamChange(const QString &teamName)
+{
+    // New teams go into the combo box in name order; existing ones only
+    // matter if they are on screen
+    int index = ui->teamComboBox->findText(teamName);
+    if (index < 0) {
+        index = 0;
+        while (index < ui->teamComboBox->count() && ui->teamComboBox->itemText(index) < teamName) {
+            ++index;
+        }
+        ui->teamComboBox->insertItem(index, teamName);
+        return;
+    }
+    if (teamName == infoTeam) {
+        displayTeamInfo();
     }
 }
 
+void MainWindow::applySouvenirChange(const QString &teamName, const QString &itemName, double price, bool removed)
+{
+    if (teamName != souvenirTeam) {
+        return;
+    }
+    QTableWidget *table = ui->resultsTable;
+    int row = 0;
+    while (row < table->rowCount() && (!table->item(row, 0) || table->item(row, 0)->text() != itemName)) {
+        ++row;
+    }
+    if (removed) {
+        if (row < table->rowCount()) {
+            table->removeRow(row);
+        }
+        return;
+    }
+    if (row == table->rowCount()) {
+        table->insertRow(row);
+        QTableWidgetItem *nameItem = new QTableWidgetItem(itemName);
+        nameItem->setFlags(nameItem->flags() & ~Qt::ItemIsEditable);
+        table->setItem(row, 0, nameItem);
+    }
+    QTableWidgetItem *priceItem = new QTableWidgetItem(QString::number(price));
+    priceItem->setFlags(priceItem->flags() & ~Qt::ItemIsEditable);
+    table->setItem(row, 1, priceItem);
+}
+
 void MainWindow::refreshData()
 {
     // Clear and repopulate the combo box
@@ -263,10 +347,9 @@ void MainWindow::refreshData()
 void MainWindow::on_adminLoginButton_clicked()
 {
     AdminLoginDialog loginDialog(db, stadiumGraph, this);
-    if (loginDialog.exec() == QDialog::Accepted) {
-        db->loadStadiumMap(); // Reload stadium and souvenir data after admin changes
-        refreshData();        // Update UI
-    }
+    // Changes made in the admin panel have already been applied through
+    // the Database change signals
+    loginDialog.exec();
 }
 
 void MainWindow::on_tripPlannerButton_clicked()
@@ -275,7 +358,13 @@ void MainWindow::on_tripPlannerButton_clicked()
         QMessageBox::warning(this, "Error", "Stadium graph not loaded.");
         return;
     }
-    TripPlanner* planner = new TripPlanner(db->getStadiumMap(), stadiumGraph, this);
+    TripPlanner* planner = new TripPlanner(db->getStadiumMap(), db->getTeamIndex(), stadiumGraph, this);
+    // The map and index are patched in place; the planner only redraws what changed
+    connect(db, &Database::teamUpserted, planner, &TripPlanner::teamChanged);
+    connect(db, &Database::souvenirAdded, planner, &TripPlanner::souvenirsChanged);
+    connect(db, &Database::souvenirUpdated, planner, &TripPlanner::souvenirsChanged);
+    connect(db, &Database::souvenirRemoved, planner, &TripPlanner::souvenirsChanged);
+    connect(db, &Database::stadiumMapReloaded, planner, &TripPlanner::refreshStadiumLists);
     planner->exec();
     delete planner;
 }
@@ -288,9 +377,12 @@ void MainWindow::on_resetDatabaseButton_clicked()
 
     // Close and delete the database file
     db->~Database();
-    QFile dbFile("baseball.db");
-    if (dbFile.exists()) {
-        dbFile.remove();
+    // WAL mode leaves -wal/-shm files beside the database
+    for (const QString &suffix : {QString(), QString("-wal"), QString("-shm")}) {
+        QFile dbFile("baseball.db" + suffix);
+        if (dbFile.exists()) {
+            dbFile.remove();
+        }
     }
 
     // Restart the application
@@ -8,6 +8,7 @@
 #include <QMessageBox>
 #include <QTableWidget>
 #include "database.h"
+#include "databaseservice.h"
 #include "souvenirdialog.h"
 #include "stadiumgraph.h"
 #include "tripplanner.h"
@@ -41,6 +42,7 @@ private slots:
     void displayTeamsByCapacity();
     void displayGreatestCenterField();
     void displaySmallestCenterField();
+    void displayFilteredTeams();
     void viewTeamSouvenirs();
     void on_adminLoginButton_clicked();
     void on_tripPlannerButton_clicked();
@@ -52,8 +54,15 @@ private:
     StadiumGraph* stadiumGraph = nullptr;
     void setupConnections();
     void clearResults();
-    void displayQueryResults(QSqlQuery &query, const QStringList &headers);
+    int latestRequest = 0;  // id of the newest async query; older results are dropped
+    void showQueryResults(QFuture<QueryResult> future, const QStringList &headers);
+    void displayQueryResults(const QueryResult &result, const QStringList &headers);
+    void appendCapacityTotal(const QueryResult &result);
     void loadTeams();
+    QString infoTeam;      // team whose details the results table shows, if any
+    QString souvenirTeam;  // team whose souvenirs the results table shows, if any
+    void applyTeamChange(const QString &teamName);
+    void applySouvenirChange(const QString &teamName, const QString &itemName, double price, bool removed);
 };
 
 #endif // MAINWINDOW_H 
\ No newline at end of file
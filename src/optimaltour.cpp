@@ -0,0 +1,521 @@
+#include "optimaltour.h"
+#include "tourimprover.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+enum EdgeState : char { Free = 0, Required = 1, Excluded = 2 };
+
+const double Infinity = std::numeric_limits<double>::infinity();
+// Subproblems whose bound is this close to the best route cannot beat it
+const double Epsilon = 1e-6;
+// Priority offset that makes Prim take required edges before any free one
+const double RequiredBias = 1e9;
+
+} // namespace
+
+struct OptimalTourSolver::Subproblem {
+    double lowerBound = -Infinity;
+    QVector<double> pi;    // Lagrangian node penalties, inherited as a warm start
+    QVector<char> state;   // n x n EdgeState
+};
+
+struct OptimalTourSolver::OneTree {
+    QVector<QPair<int, int>> edges;
+    QVector<int> degree;
+    double value = 0.0;
+
+    bool isTour() const {
+        for (int d : degree) {
+            if (d != 2) return false;
+        }
+        return true;
+    }
+};
+
+OptimalTourSolver::OptimalTourSolver(const QVector<double>& stopDist, int stopCount)
+    : k(stopCount), n(stopCount + 1), dist(n * n, 0.0) {
+    // The depot (index k) is 0 miles from every stop
+    for (int a = 0; a < k; ++a) {
+        for (int b = 0; b < k; ++b) {
+            dist[a * n + b] = stopDist[a * k + b];
+        }
+    }
+}
+
+// Minimum 1-tree under penalties pi: a spanning tree over the real stops (Prim,
+// required edges first) plus the depot's two cheapest allowed edges
+bool OptimalTourSolver::buildOneTree(const Subproblem& node, const QVector<double>& pi, OneTree& tree) const {
+    const int depot = k;
+    tree.edges.clear();
+    tree.degree = QVector<int>(n, 0);
+    tree.value = 0.0;
+
+    QVector<double> key(k, Infinity);
+    QVector<double> weight(k, 0.0);
+    QVector<int> parent(k, -1);
+    QVector<bool> inTree(k, false);
+    key[0] = 0.0;
+    for (int step = 0; step < k; ++step) {
+        int v = -1;
+        for (int u = 0; u < k; ++u) {
+            if (!inTree[u] && (v < 0 || key[u] < key[v])) {
+                v = u;
+            }
+        }
+        if (key[v] == Infinity) {
+            return false; // the allowed edges do not connect every stop
+        }
+        inTree[v] = true;
+        if (parent[v] >= 0) {
+            tree.edges.append(qMakePair(parent[v], v));
+            tree.value += weight[v];
+        }
+        for (int u = 0; u < k; ++u) {
+            char s = node.state[v * n + u];
+            if (inTree[u] || s == Excluded) {
+                continue;
+            }
+            double w = cost(v, u) + pi[v] + pi[u];
+            double priority = s == Required ? w - RequiredBias : w;
+            if (priority < key[u]) {
+                key[u] = priority;
+                weight[u] = w;
+                parent[u] = v;
+            }
+        }
+    }
+
+    int first = -1;
+    int second = -1;
+    double firstKey = Infinity;
+    double secondKey = Infinity;
+    for (int u = 0; u < k; ++u) {
+        char s = node.state[depot * n + u];
+        if (s == Excluded) {
+            continue;
+        }
+        double priority = cost(depot, u) + pi[depot] + pi[u] - (s == Required ? RequiredBias : 0.0);
+        if (priority < firstKey) {
+            second = first;
+            secondKey = firstKey;
+            first = u;
+            firstKey = priority;
+        } else if (priority < secondKey) {
+            second = u;
+            secondKey = priority;
+        }
+    }
+    if (second < 0) {
+        return false;
+    }
+    tree.edges.append(qMakePair(depot, first));
+    tree.edges.append(qMakePair(depot, second));
+    tree.value += cost(depot, first) + cost(depot, second) + 2 * pi[depot] + pi[first] + pi[second];
+
+    for (const auto& e : tree.edges) {
+        ++tree.degree[e.first];
+        ++tree.degree[e.second];
+    }
+    for (double p : pi) {
+        tree.value -= 2 * p;
+    }
+    return true;
+}
+
+// Subgradient ascent on the 1-tree bound, starting from node.pi. Leaves the best
+// bound and penalties in node and the matching 1-tree in tree; false if infeasible.
+bool OptimalTourSolver::bound(Subproblem& node, int iterations, double upperBound, OneTree& tree) const {
+    QVector<double> pi = node.pi;
+    QVector<double> bestPi = pi;
+    double best = -Infinity;
+    double lambda = 2.0;
+    int stall = 0;
+
+    for (int it = 0; it < iterations; ++it) {
+        if (!buildOneTree(node, pi, tree)) {
+            return false;
+        }
+        if (tree.value > best + Epsilon) {
+            best = tree.value;
+            bestPi = pi;
+            stall = 0;
+        } else if (++stall >= 5) {
+            lambda *= 0.5;
+            stall = 0;
+        }
+        double norm = 0.0;
+        for (int d : tree.degree) {
+            norm += double(d - 2) * (d - 2);
+        }
+        if (norm == 0.0) {
+            // Every degree is 2: this 1-tree is a tour and its bound is its length
+            node.pi = pi;
+            node.lowerBound = tree.value;
+            return true;
+        }
+        if (best >= upperBound - Epsilon || lambda < 1e-4) {
+            break;
+        }
+        double target = upperBound < Infinity ? upperBound : best + qMax(1.0, qAbs(best) * 0.05);
+        double step = lambda * (target - tree.value) / norm;
+        for (int v = 0; v < n; ++v) {
+            pi[v] += step * (tree.degree[v] - 2);
+        }
+    }
+
+    node.pi = bestPi;
+    node.lowerBound = best;
+    return buildOneTree(node, bestPi, tree);
+}
+
+// Fixes forced edges (a stop with two required edges loses the rest, a stop
+// with only two usable edges needs both) and forbids edges that would close a
+// short cycle. Returns false if the subproblem has no tour.
+bool OptimalTourSolver::propagate(Subproblem& node) const {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int v = 0; v < n; ++v) {
+            int required = 0;
+            int free = 0;
+            for (int u = 0; u < n; ++u) {
+                if (u == v) continue;
+                char s = node.state[v * n + u];
+                if (s == Required) ++required;
+                else if (s == Free) ++free;
+            }
+            if (required > 2 || required + free < 2) {
+                return false;
+            }
+            if (free == 0) {
+                continue;
+            }
+            if (required == 2 || required + free == 2) {
+                char fixed = required == 2 ? Excluded : Required;
+                for (int u = 0; u < n; ++u) {
+                    if (u != v && node.state[v * n + u] == Free) {
+                        node.state[v * n + u] = fixed;
+                        node.state[u * n + v] = fixed;
+                    }
+                }
+                changed = true;
+            }
+        }
+
+        // Required edges form paths; an edge joining the two ends of one path
+        // would close a cycle, which is only allowed once it covers every stop
+        QVector<int> root(n);
+        QVector<int> size(n, 1);
+        for (int v = 0; v < n; ++v) root[v] = v;
+        auto find = [&](int v) {
+            while (root[v] != v) {
+                root[v] = root[root[v]];
+                v = root[v];
+            }
+            return v;
+        };
+        int requiredEdges = 0;
+        for (int a = 0; a < n; ++a) {
+            for (int b = a + 1; b < n; ++b) {
+                if (node.state[a * n + b] != Required) continue;
+                ++requiredEdges;
+                int ra = find(a);
+                int rb = find(b);
+                if (ra == rb) {
+                    if (size[ra] < n) return false;
+                    continue;
+                }
+                root[rb] = ra;
+                size[ra] += size[rb];
+            }
+        }
+        for (int a = 0; a < n; ++a) {
+            for (int b = a + 1; b < n; ++b) {
+                if (node.state[a * n + b] != Free) continue;
+                int r = find(a);
+                if (r == find(b) && !(size[r] == n && requiredEdges == n - 1)) {
+                    node.state[a * n + b] = Excluded;
+                    node.state[b * n + a] = Excluded;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Splits on the stop with the highest 1-tree degree, using two of its free tree
+// edges e1, e2: {e1 out}, {e1 in, e2 out}, {e1 in, e2 in}
+QVector<OptimalTourSolver::Subproblem> OptimalTourSolver::branch(const Subproblem& node, const OneTree& tree) const {
+    int v = -1;
+    for (int u = 0; u < k; ++u) {
+        if (tree.degree[u] > 2 && (v < 0 || tree.degree[u] > tree.degree[v])) {
+            v = u;
+        }
+    }
+    QVector<Subproblem> children;
+    if (v < 0) {
+        return children;
+    }
+
+    QVector<int> freeNeighbors;
+    int required = 0;
+    for (const auto& e : tree.edges) {
+        int other = e.first == v ? e.second : (e.second == v ? e.first : -1);
+        if (other < 0) continue;
+        if (node.state[v * n + other] == Free) freeNeighbors.append(other);
+        else ++required;
+    }
+    // Branch on the longest edges first; they are the likeliest to be wrong
+    std::sort(freeNeighbors.begin(), freeNeighbors.end(),
+              [&](int a, int b) { return cost(v, a) > cost(v, b); });
+
+    auto set = [&](Subproblem& child, int u, char s) {
+        child.state[v * n + u] = s;
+        child.state[u * n + v] = s;
+    };
+    const int e1 = freeNeighbors.value(0, -1);
+    const int e2 = freeNeighbors.value(1, -1);
+    if (e1 < 0) {
+        return children;
+    }
+    Subproblem out1 = node;
+    set(out1, e1, Excluded);
+    children.append(out1);
+    if (required == 0 && e2 >= 0) {
+        Subproblem in1out2 = node;
+        set(in1out2, e1, Required);
+        set(in1out2, e2, Excluded);
+        children.append(in1out2);
+        Subproblem in12 = node;
+        set(in12, e1, Required);
+        set(in12, e2, Required);
+        children.append(in12);
+    } else {
+        Subproblem in1 = node;
+        set(in1, e1, Required);
+        children.append(in1);
+    }
+
+    QVector<Subproblem> feasible;
+    for (Subproblem& child : children) {
+        if (propagate(child)) {
+            feasible.append(child);
+        }
+    }
+    return feasible;
+}
+
+QVector<int> OptimalTourSolver::tourFromTree(const OneTree& tree) const {
+    QVector<QVector<int>> next(n);
+    for (const auto& e : tree.edges) {
+        next[e.first].append(e.second);
+        next[e.second].append(e.first);
+    }
+    // Walk away from the depot through the start stop
+    QVector<int> order;
+    int previous = k;
+    int current = startStop;
+    while (current != k) {
+        order.append(current);
+        int step = next[current][0] == previous ? next[current][1] : next[current][0];
+        previous = current;
+        current = step;
+    }
+    return order;
+}
+
+// Nearest neighbor from start, tightened with 2-opt/Or-opt; -1 if it gets stuck
+double OptimalTourSolver::initialRoute(int start, QVector<int>& order) const {
+    QVector<double> stopDist(k * k);
+    for (int a = 0; a < k; ++a) {
+        for (int b = 0; b < k; ++b) {
+            stopDist[a * k + b] = cost(a, b);
+        }
+    }
+    QVector<bool> visited(k, false);
+    order.clear();
+    order.append(start);
+    visited[start] = true;
+    for (int step = 1; step < k; ++step) {
+        int current = order.last();
+        int nearest = -1;
+        for (int v = 0; v < k; ++v) {
+            if (!visited[v] && cost(current, v) >= 0 && (nearest < 0 || cost(current, v) < cost(current, nearest))) {
+                nearest = v;
+            }
+        }
+        if (nearest < 0) {
+            order.clear();
+            return -1.0;
+        }
+        visited[nearest] = true;
+        order.append(nearest);
+    }
+    TourImprover improver(stopDist, k);
+    double length = improver.improve(order, true);
+    for (int i = 0; i + 1 < order.size(); ++i) {
+        if (cost(order[i], order[i + 1]) < 0) {
+            return -1.0; // the improver could not get rid of a missing link
+        }
+    }
+    return length;
+}
+
+OptimalTourResult OptimalTourSolver::solve(int start, int timeLimitMs, int threadCount) {
+    OptimalTourResult result;
+    if (start < 0 || start >= k) {
+        return result;
+    }
+    startStop = start;
+    if (k <= 2) {
+        result.order.append(start);
+        if (k == 2) {
+            if (cost(0, 1) < 0) return OptimalTourResult();
+            result.order.append(1 - start);
+        }
+        result.length = k == 2 ? cost(0, 1) : 0.0;
+        result.lowerBound = result.length;
+        result.provenOptimal = true;
+        return result;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Subproblem root;
+    root.pi = QVector<double>(n, 0.0);
+    root.state = QVector<char>(n * n, Free);
+    for (int a = 0; a < n; ++a) {
+        for (int b = 0; b < n; ++b) {
+            if (a == b || cost(a, b) < 0) {
+                root.state[a * n + b] = Excluded;
+            }
+        }
+    }
+    root.state[k * n + start] = Required;
+    root.state[start * n + k] = Required;
+    if (!propagate(root)) {
+        return result;
+    }
+
+    QVector<int> bestOrder;
+    double bestLength = initialRoute(start, bestOrder);
+    if (bestLength < 0) {
+        bestLength = Infinity;
+        bestOrder.clear();
+    }
+
+    OneTree tree;
+    if (!bound(root, 40 * n, bestLength, tree)) {
+        return result;
+    }
+    if (tree.isTour() && root.lowerBound < bestLength) {
+        bestLength = root.lowerBound;
+        bestOrder = tourFromTree(tree);
+    }
+
+    // Best-first search shared by the workers
+    auto later = [](const Subproblem& a, const Subproblem& b) { return a.lowerBound > b.lowerBound; };
+    QVector<Subproblem> open;
+    if (root.lowerBound < bestLength - Epsilon) {
+        open.append(root);
+    }
+    QMutex mutex;
+    QWaitCondition changed;
+    int busy = 0;
+    bool timedOut = false;
+    int explored = 1;
+    const int childIterations = qMax(20, n);
+
+    auto worker = [&]() {
+        OneTree parentTree;
+        OneTree childTree;
+        while (true) {
+            Subproblem node;
+            double upperBound;
+            {
+                QMutexLocker locker(&mutex);
+                while (true) {
+                    if (timer.hasExpired(timeLimitMs)) {
+                        timedOut = true;
+                    }
+                    if (timedOut || (open.isEmpty() && busy == 0)) {
+                        changed.wakeAll();
+                        return;
+                    }
+                    if (!open.isEmpty()) break;
+                    changed.wait(&mutex, 50);
+                }
+                std::pop_heap(open.begin(), open.end(), later);
+                node = open.takeLast();
+                if (node.lowerBound >= bestLength - Epsilon) {
+                    continue;
+                }
+                ++busy;
+                ++explored;
+                upperBound = bestLength;
+            }
+
+            QVector<Subproblem> kept;
+            buildOneTree(node, node.pi, parentTree);
+            for (Subproblem& child : branch(node, parentTree)) {
+                if (!bound(child, childIterations, upperBound, childTree)) {
+                    continue;
+                }
+                if (childTree.isTour()) {
+                    QMutexLocker locker(&mutex);
+                    if (child.lowerBound < bestLength) {
+                        bestLength = child.lowerBound;
+                        bestOrder = tourFromTree(childTree);
+                    }
+                    upperBound = bestLength;
+                } else if (child.lowerBound < upperBound - Epsilon) {
+                    kept.append(child);
+                }
+            }
+
+            QMutexLocker locker(&mutex);
+            for (const Subproblem& child : kept) {
+                open.append(child);
+                std::push_heap(open.begin(), open.end(), later);
+            }
+            --busy;
+            changed.wakeAll();
+        }
+    };
+
+    const int threads = threadCount > 0 ? threadCount : qMax(1, QThread::idealThreadCount());
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int t = 0; t < threads; ++t) {
+        QtConcurrent::run(&pool, worker);
+    }
+    pool.waitForDone();
+
+    if (bestLength == Infinity) {
+        return result;
+    }
+    result.order = bestOrder;
+    result.length = bestLength;
+    result.nodesExplored = explored;
+    result.lowerBound = bestLength;
+    for (const Subproblem& node : open) {
+        result.lowerBound = qMin(result.lowerBound, node.lowerBound);
+    }
+    result.lowerBound = qMax(result.lowerBound, root.lowerBound);
+    result.provenOptimal = !timedOut || open.isEmpty();
+    qDebug() << "OptimalTourSolver:" << explored << "subproblems in" << timer.elapsed() << "ms, length"
+             << bestLength << "gap" << result.gap();
+    return result;
+}
@@ -0,0 +1,47 @@
+#ifndef OPTIMALTOUR_H
+#define OPTIMALTOUR_H
+
+#include <QVector>
+
+struct OptimalTourResult {
+    QVector<int> order;       // stop indices, beginning with the start stop
+    double length = -1.0;     // -1 if no route connects every stop
+    double lowerBound = 0.0;  // no route can be shorter than this
+    bool provenOptimal = false;
+    int nodesExplored = 0;
+
+    // Relative distance between the route found and the lower bound (0 when proven)
+    double gap() const { return length > 0 ? qMax(0.0, (length - lowerBound) / length) : 0.0; }
+};
+
+// Exact shortest open route from a fixed start through every stop, by branch
+// and bound on Held-Karp 1-tree Lagrangian bounds. The open route is solved as
+// a tour through an extra free "depot" stop whose edge to the start is forced.
+// Open subproblems are shared in a best-first queue by several worker threads;
+// if the time limit is hit the best route so far is returned with its gap.
+class OptimalTourSolver {
+public:
+    // dist is a row-major k x k matrix of stop distances, negative where there is no path
+    OptimalTourSolver(const QVector<double>& dist, int k);
+
+    OptimalTourResult solve(int start, int timeLimitMs = 10000, int threadCount = 0);
+
+private:
+    struct Subproblem;
+    struct OneTree;
+
+    double cost(int a, int b) const { return dist[a * n + b]; }
+    bool buildOneTree(const Subproblem& node, const QVector<double>& pi, OneTree& tree) const;
+    bool bound(Subproblem& node, int iterations, double upperBound, OneTree& tree) const;
+    QVector<Subproblem> branch(const Subproblem& node, const OneTree& tree) const;
+    bool propagate(Subproblem& node) const;
+    QVector<int> tourFromTree(const OneTree& tree) const;
+    double initialRoute(int start, QVector<int>& order) const;
+
+    int k;                  // real stops
+    int startStop = 0;
+    int n;                  // stops plus the depot (index k)
+    QVector<double> dist;   // n x n, depot included
+};
+
+#endif // OPTIMALTOUR_H
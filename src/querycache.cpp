@@ -0,0 +1,106 @@
+#include "querycache.h"
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlRecord>
+
+QueryResult QueryResult::fromQuery(QSqlQuery &query)
+{
+    QueryResult result;
+    if (!query.isActive()) {
+        result.error = query.lastError().text();
+        if (result.error.isEmpty()) {
+            result.error = "Query was not executed";
+        }
+        return result;
+    }
+    const int columns = query.record().count();
+    while (query.next()) {
+        QVector<QVariant> row;
+        row.reserve(columns);
+        for (int col = 0; col < columns; ++col) {
+            row.append(query.value(col));
+        }
+        result.rows.append(row);
+    }
+    return result;
+}
+
+QueryCache::Stamp QueryCache::stamp() const
+{
+    QMutexLocker locker(&mutex);
+    return generations;
+}
+
+bool QueryCache::isCurrent(const Entry &entry) const
+{
+    for (int t = 0; t < int(generations.size()); ++t) {
+        if (entry.tables.testFlag(Table(1 << t)) && entry.readAt[t] != generations[t]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool QueryCache::find(const Key &key, QueryResult &result)
+{
+    QMutexLocker locker(&mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        ++missCount;
+        return false;
+    }
+    if (!isCurrent(it.value())) {
+        entries.erase(it);
+        ++missCount;
+        return false;
+    }
+    result = it.value().result;
+    ++hitCount;
+    return true;
+}
+
+void QueryCache::insert(const Key &key, Tables tables, const Stamp &readAt, const QueryResult &result)
+{
+    QMutexLocker locker(&mutex);
+    Entry entry{tables, readAt, result};
+    if (!isCurrent(entry)) {
+        return;  // a write landed while the query ran
+    }
+    if (entries.size() >= MaxEntries && !entries.contains(key)) {
+        // Drop stale entries first; if everything is current, start over
+        auto it = entries.begin();
+        while (it != entries.end()) {
+            if (isCurrent(it.value())) {
+                ++it;
+            } else {
+                it = entries.erase(it);
+            }
+        }
+        if (entries.size() >= MaxEntries) {
+            entries.clear();
+        }
+    }
+    entries.insert(key, entry);
+}
+
+void QueryCache::invalidate(Tables tables)
+{
+    QMutexLocker locker(&mutex);
+    for (int t = 0; t < int(generations.size()); ++t) {
+        if (tables.testFlag(Table(1 << t))) {
+            ++generations[t];
+        }
+    }
+}
+
+int QueryCache::hits() const
+{
+    QMutexLocker locker(&mutex);
+    return hitCount;
+}
+
+int QueryCache::misses() const
+{
+    QMutexLocker locker(&mutex);
+    return missCount;
+}
@@ -0,0 +1,71 @@
+#ifndef QUERYCACHE_H
+#define QUERYCACHE_H
+
+#include <QFlags>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSqlQuery>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <array>
+
+// Rows of one statement, copied out of a QSqlQuery so they can be cached and
+// cross threads. Write statements leave rows empty.
+struct QueryResult {
+    QVector<QVector<QVariant>> rows;
+    QString error;
+
+    bool ok() const { return error.isEmpty(); }
+    int rowCount() const { return rows.size(); }
+    QVariant value(int row, int column) const { return rows[row].value(column); }
+
+    static QueryResult fromQuery(QSqlQuery &query);  // drains an executed SELECT
+};
+
+// Results of read-only queries, shared by every Database connection to one
+// file. Each table has a write generation; an entry records the generations
+// of the tables it read, taken before the query ran, and is served only while
+// none of them has moved. Writers call invalidate() after their change is
+// committed, so a read that raced the write is never stored as current.
+class QueryCache {
+public:
+    enum Table {
+        Teams = 0x1,
+        Souvenirs = 0x2,
+        Distances = 0x4
+    };
+    Q_DECLARE_FLAGS(Tables, Table)
+
+    using Key = QPair<int, QString>;          // query identity, parameter
+    using Stamp = std::array<quint64, 3>;     // generation per table
+
+    Stamp stamp() const;                      // take before running the query
+    bool find(const Key &key, QueryResult &result);
+    void insert(const Key &key, Tables tables, const Stamp &readAt, const QueryResult &result);
+    void invalidate(Tables tables);
+
+    int hits() const;
+    int misses() const;
+
+private:
+    struct Entry {
+        Tables tables;
+        Stamp readAt;
+        QueryResult result;
+    };
+    static const int MaxEntries = 256;
+
+    bool isCurrent(const Entry &entry) const;
+
+    mutable QMutex mutex;
+    Stamp generations{};
+    QHash<Key, Entry> entries;
+    int hitCount = 0;
+    int missCount = 0;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(QueryCache::Tables)
+
+#endif // QUERYCACHE_H
@@ -0,0 +1,85 @@
+#ifndef ROWBITMAP_H
+#define ROWBITMAP_H
+
+#include <QVector>
+#include <QtAlgorithms>
+
+// Set of dense row ids, one bit per row in 64-bit words. Combining two sets is
+// a loop over words, so a filter over every team costs n/64 operations per
+// attribute. Words past the end of a bitmap count as zero.
+class RowBitmap {
+public:
+    void set(int row) {
+        const int word = row >> 6;
+        if (word >= words.size()) {
+            words.resize(word + 1);
+        }
+        words[word] |= quint64(1) << (row & 63);
+    }
+
+    void clear(int row) {
+        const int word = row >> 6;
+        if (word < words.size()) {
+            words[word] &= ~(quint64(1) << (row & 63));
+        }
+    }
+
+    bool test(int row) const {
+        const int word = row >> 6;
+        return word < words.size() && (words[word] >> (row & 63)) & 1;
+    }
+
+    RowBitmap& operator|=(const RowBitmap& other) {
+        if (other.words.size() > words.size()) {
+            words.resize(other.words.size());
+        }
+        for (int i = 0; i < other.words.size(); ++i) {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    RowBitmap& operator&=(const RowBitmap& other) {
+        if (words.size() > other.words.size()) {
+            words.resize(other.words.size());
+        }
+        for (int i = 0; i < words.size(); ++i) {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    int count() const {
+        int total = 0;
+        for (quint64 word : words) {
+            total += qPopulationCount(word);
+        }
+        return total;
+    }
+
+    bool isEmpty() const {
+        for (quint64 word : words) {
+            if (word) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Calls fn(row) for every set bit, in row order
+    template<typename Fn>
+    void forEach(Fn fn) const {
+        for (int i = 0; i < words.size(); ++i) {
+            quint64 word = words[i];
+            while (word) {
+                fn(i * 64 + int(qCountTrailingZeroBits(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+private:
+    QVector<quint64> words;
+};
+
+#endif // ROWBITMAP_H
@@ -0,0 +1,228 @@
+#include "schemamigrator.h"
+#include "teamcsv.h"
+#include <QSqlError>
+#include <QVariant>
+#include <QDebug>
+
+SchemaMigrator::SchemaMigrator(const QSqlDatabase& connection)
+    : db(connection)
+{
+}
+
+int SchemaMigrator::version() {
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        error = query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+bool SchemaMigrator::migrate() {
+    const int current = version();
+    if (current < 0) {
+        qDebug() << "Error reading schema version:" << error;
+        return false;
+    }
+    if (current > CurrentVersion) {
+        error = QString("Database schema version %1 is newer than this program (%2)")
+                    .arg(current).arg(CurrentVersion);
+        qDebug() << error;
+        return false;
+    }
+    if (current < 1 && !run(1, &SchemaMigrator::createVersion1)) {
+        return false;
+    }
+    if (current < 2 && !run(2, &SchemaMigrator::upgradeToVersion2)) {
+        return false;
+    }
+    if (current < 3 && !run(3, &SchemaMigrator::upgradeToVersion3)) {
+        return false;
+    }
+    return true;
+}
+
+bool SchemaMigrator::run(int target, bool (SchemaMigrator::*step)()) {
+    if (!db.transaction()) {
+        error = db.lastError().text();
+        qDebug() << "Error starting schema migration:" << error;
+        return false;
+    }
+    if (!(this->*step)() || !exec(QString("PRAGMA user_version = %1").arg(target))) {
+        db.rollback();
+        qDebug() << "Schema migration to version" << target << "failed:" << error;
+        return false;
+    }
+    if (!db.commit()) {
+        error = db.lastError().text();
+        db.rollback();
+        qDebug() << "Error committing schema migration:" << error;
+        return false;
+    }
+    qDebug() << "Database schema migrated to version" << target;
+    return true;
+}
+
+bool SchemaMigrator::exec(const QString& sql) {
+    QSqlQuery query(db);
+    if (!query.exec(sql)) {
+        error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// Files written before versioning existed already have these tables (and
+// user_version 0), so everything here is IF NOT EXISTS
+bool SchemaMigrator::createVersion1() {
+    return exec("CREATE TABLE IF NOT EXISTS teams ("
+                "team_name TEXT PRIMARY KEY,"
+                "stadium_name TEXT,"
+                "capacity INTEGER,"
+                "location TEXT,"
+                "surface TEXT,"
+                "league TEXT,"
+                "date_opened TEXT,"
+                "center_field INTEGER,"
+                "typology TEXT,"
+                "roof TEXT)")
+        && exec("CREATE TABLE IF NOT EXISTS souvenirs ("
+                "team_name TEXT,"
+                "item_name TEXT,"
+                "price REAL,"
+                "PRIMARY KEY (team_name, item_name),"
+                "FOREIGN KEY (team_name) REFERENCES teams(team_name))")
+        && exec("CREATE TABLE IF NOT EXISTS distances ("
+                "from_team TEXT,"
+                "to_team TEXT,"
+                "distance INTEGER,"
+                "PRIMARY KEY (from_team, to_team))");
+}
+
+// Rebuilds all three tables. Text is trimmed on the way in, so queries can
+// compare columns directly instead of TRIM(col), which no index can serve.
+// Rows that collide once trimmed keep the first copy; souvenirs of missing
+// teams are dropped.
+bool SchemaMigrator::upgradeToVersion2() {
+    return exec("CREATE TABLE teams_v2 ("
+                "team_id INTEGER PRIMARY KEY,"
+                "team_name TEXT NOT NULL UNIQUE,"
+                "stadium_name TEXT,"
+                "capacity INTEGER,"
+                "location TEXT,"
+                "surface TEXT,"
+                "league TEXT,"
+                "date_opened TEXT,"
+                "center_field INTEGER,"
+                "typology TEXT,"
+                "roof TEXT,"
+                "league_key TEXT GENERATED ALWAYS AS (UPPER(TRIM(league))) STORED,"
+                "roof_key TEXT GENERATED ALWAYS AS (UPPER(TRIM(roof))) STORED)")
+        && exec("INSERT OR IGNORE INTO teams_v2 (team_name, stadium_name, capacity, location, "
+                "surface, league, date_opened, center_field, typology, roof) "
+                "SELECT TRIM(team_name), TRIM(stadium_name), capacity, TRIM(location), "
+                "TRIM(surface), TRIM(league), TRIM(date_opened), center_field, "
+                "TRIM(typology), TRIM(roof) FROM teams "
+                "WHERE team_name IS NOT NULL AND TRIM(team_name) != '' ORDER BY rowid")
+
+        && exec("CREATE TABLE souvenirs_v2 ("
+                "souvenir_id INTEGER PRIMARY KEY,"
+                "team_id INTEGER NOT NULL REFERENCES teams_v2(team_id),"
+                "item_name TEXT NOT NULL,"
+                "price REAL,"
+                "UNIQUE (team_id, item_name))")
+        && exec("INSERT OR IGNORE INTO souvenirs_v2 (team_id, item_name, price) "
+                "SELECT t.team_id, TRIM(s.item_name), s.price FROM souvenirs s "
+                "JOIN teams_v2 t ON t.team_name = TRIM(s.team_name) "
+                "WHERE s.item_name IS NOT NULL ORDER BY s.rowid")
+
+        // Distance endpoints are stadium names, which need not match any team
+        && exec("CREATE TABLE stadiums ("
+                "stadium_id INTEGER PRIMARY KEY,"
+                "name TEXT NOT NULL UNIQUE)")
+        && exec("INSERT OR IGNORE INTO stadiums (name) "
+                "SELECT TRIM(from_team) FROM distances UNION SELECT TRIM(to_team) FROM distances")
+        && exec("CREATE TABLE distances_v2 ("
+                "from_id INTEGER NOT NULL REFERENCES stadiums(stadium_id),"
+                "to_id INTEGER NOT NULL REFERENCES stadiums(stadium_id),"
+                "distance INTEGER,"
+                "PRIMARY KEY (from_id, to_id)) WITHOUT ROWID")
+        && exec("INSERT OR REPLACE INTO distances_v2 (from_id, to_id, distance) "
+                "SELECT f.stadium_id, t.stadium_id, d.distance FROM distances d "
+                "JOIN stadiums f ON f.name = TRIM(d.from_team) "
+                "JOIN stadiums t ON t.name = TRIM(d.to_team) ORDER BY d.rowid")
+
+        && exec("DROP TABLE souvenirs")
+        && exec("DROP TABLE distances")
+        && exec("DROP TABLE teams")
+        && exec("ALTER TABLE teams_v2 RENAME TO teams")
+        && exec("ALTER TABLE souvenirs_v2 RENAME TO souvenirs")
+        && exec("ALTER TABLE distances_v2 RENAME TO distances")
+
+        // Covering indexes for the filtered team lists and per-team souvenirs
+        && exec("CREATE INDEX teams_league_idx ON teams (league_key, team_name, stadium_name)")
+        && exec("CREATE INDEX teams_roof_idx ON teams (roof_key, team_name)")
+        && exec("CREATE INDEX teams_typology_idx ON teams (typology, team_name, stadium_name)")
+        && exec("CREATE INDEX souvenirs_team_idx ON souvenirs (team_id, item_name, price)");
+}
+
+// Moves the default souvenirs every team had its own copy of into one shared
+// catalog. A team's remaining souvenirs rows are what sets it apart: a
+// catalog item at another price, an item of its own, or (hidden = 1) a
+// catalog item it didn't have. team_souvenirs puts the two back together,
+// catalog items first.
+bool SchemaMigrator::upgradeToVersion3() {
+    if (!exec("CREATE TABLE souvenir_catalog ("
+              "item_id INTEGER PRIMARY KEY,"
+              "item_name TEXT NOT NULL UNIQUE,"
+              "price REAL)")) {
+        return false;
+    }
+    QSqlQuery seed(db);
+    if (!seed.prepare("INSERT INTO souvenir_catalog (item_name, price) VALUES (?, ?)")) {
+        error = seed.lastError().text();
+        return false;
+    }
+    for (const auto& souvenir : TeamCsv::defaultSouvenirs()) {
+        seed.bindValue(0, souvenir.first);
+        seed.bindValue(1, souvenir.second);
+        if (!seed.exec()) {
+            error = seed.lastError().text();
+            return false;
+        }
+    }
+
+    return exec("CREATE TABLE souvenirs_v3 ("
+                "souvenir_id INTEGER PRIMARY KEY,"
+                "team_id INTEGER NOT NULL REFERENCES teams(team_id),"
+                "item_name TEXT NOT NULL,"
+                "price REAL,"
+                "hidden INTEGER NOT NULL DEFAULT 0,"
+                "UNIQUE (team_id, item_name))")
+        && exec("INSERT INTO souvenirs_v3 (team_id, item_name, price) "
+                "SELECT s.team_id, s.item_name, s.price FROM souvenirs s "
+                "LEFT JOIN souvenir_catalog c ON c.item_name = s.item_name "
+                "WHERE c.item_id IS NULL OR s.price IS NOT c.price ORDER BY s.rowid")
+        && exec("INSERT INTO souvenirs_v3 (team_id, item_name, hidden) "
+                "SELECT t.team_id, c.item_name, 1 FROM teams t CROSS JOIN souvenir_catalog c "
+                "WHERE NOT EXISTS (SELECT 1 FROM souvenirs s "
+                "WHERE s.team_id = t.team_id AND s.item_name = c.item_name) "
+                "ORDER BY t.team_id, c.item_id")
+        && exec("DROP TABLE souvenirs")
+        && exec("ALTER TABLE souvenirs_v3 RENAME TO souvenirs")
+        && exec("CREATE INDEX souvenirs_team_idx ON souvenirs (team_id, item_name, price, hidden)")
+
+        // from_catalog and position order a team's list; see SouvenirList::items().
+        // Both halves carry team_name so a filter on it reaches the indexes.
+        && exec("CREATE VIEW team_souvenirs AS "
+                "SELECT t.team_id, t.team_name, c.item_name, COALESCE(s.price, c.price) AS price, "
+                "1 AS from_catalog, c.item_id AS position "
+                "FROM teams t CROSS JOIN souvenir_catalog c "
+                "LEFT JOIN souvenirs s ON s.team_id = t.team_id AND s.item_name = c.item_name "
+                "WHERE COALESCE(s.hidden, 0) = 0 "
+                "UNION ALL "
+                "SELECT t.team_id, t.team_name, s.item_name, s.price, 0, s.souvenir_id "
+                "FROM souvenirs s JOIN teams t ON t.team_id = s.team_id "
+                "WHERE s.hidden = 0 AND NOT EXISTS "
+                "(SELECT 1 FROM souvenir_catalog c WHERE c.item_name = s.item_name)");
+}
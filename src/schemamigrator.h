@@ -0,0 +1,41 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+// Versioned schema upgrades for baseball.db. The version lives in
+// PRAGMA user_version; each step runs in its own transaction and bumps the
+// version as its last statement, so a failed step leaves the file untouched.
+//
+//   1  original layout: tables keyed by free-text names
+//   2  integer surrogate keys (teams.team_id, stadiums.stadium_id), trimmed
+//      text, stored upper-case league/roof keys and covering indexes
+//   3  shared souvenir_catalog; souvenirs only holds per-team differences,
+//      read back through the team_souvenirs view
+class SchemaMigrator {
+public:
+    static const int CurrentVersion = 3;
+
+    explicit SchemaMigrator(const QSqlDatabase& connection);
+
+    // Applies every step above the file's version. False on the first failure.
+    bool migrate();
+    int version();  // -1 if it can't be read
+
+    QString lastError() const { return error; }
+
+private:
+    bool run(int version, bool (SchemaMigrator::*step)());
+    bool exec(const QString& sql);
+
+    bool createVersion1();
+    bool upgradeToVersion2();
+    bool upgradeToVersion3();
+
+    QSqlDatabase db;
+    QString error;
+};
+
+#endif // SCHEMAMIGRATOR_H
@@ -0,0 +1,114 @@
+#include "searchworkspace.h"
+#include "csrgraph.h"
+#include <limits>
+
+SearchWorkspace& SearchWorkspace::local() {
+    thread_local SearchWorkspace workspace;
+    return workspace;
+}
+
+void SearchWorkspace::reset(int nodeCount) {
+    if (stamp.size() < nodeCount) {
+        stamp.resize(nodeCount);
+        dist.resize(nodeCount);
+        prev.resize(nodeCount);
+        heapIndex.resize(nodeCount);
+    }
+    heap.clear();
+    if (++generation == 0) {
+        // The stamp wrapped around; old entries could now look current
+        stamp.fill(0);
+        generation = 1;
+    }
+}
+
+double SearchWorkspace::distance(int v) const {
+    return reached(v) ? dist[v] : std::numeric_limits<double>::infinity();
+}
+
+bool SearchWorkspace::relax(int v, double d, int from) {
+    if (!reached(v)) {
+        stamp[v] = generation;
+        dist[v] = d;
+        prev[v] = from;
+        heap.append(v);
+        heapIndex[v] = heap.size() - 1;
+        siftUp(heap.size() - 1);
+        return true;
+    }
+    if (heapIndex[v] == Settled || d >= dist[v]) {
+        return false;
+    }
+    dist[v] = d;
+    prev[v] = from;
+    siftUp(heapIndex[v]);
+    return true;
+}
+
+int SearchWorkspace::popMin() {
+    int top = heap.first();
+    int last = heap.takeLast();
+    if (!heap.isEmpty()) {
+        place(0, last);
+        siftDown(0);
+    }
+    heapIndex[top] = Settled;
+    return top;
+}
+
+void SearchWorkspace::siftUp(int i) {
+    int v = heap[i];
+    double key = dist[v];
+    while (i > 0) {
+        int parent = (i - 1) / Arity;
+        if (dist[heap[parent]] <= key) {
+            break;
+        }
+        place(i, heap[parent]);
+        i = parent;
+    }
+    place(i, v);
+}
+
+void SearchWorkspace::siftDown(int i) {
+    const int n = heap.size();
+    int v = heap[i];
+    double key = dist[v];
+    while (true) {
+        int first = i * Arity + 1;
+        if (first >= n) {
+            break;
+        }
+        int last = qMin(first + Arity, n);
+        int best = first;
+        for (int c = first + 1; c < last; ++c) {
+            if (dist[heap[c]] < dist[heap[best]]) {
+                best = c;
+            }
+        }
+        if (dist[heap[best]] >= key) {
+            break;
+        }
+        place(i, heap[best]);
+        i = best;
+    }
+    place(i, v);
+}
+
+const SearchWorkspace& shortestPathTree(const CsrGraph& graph, int source, int target) {
+    SearchWorkspace& ws = SearchWorkspace::local();
+    ws.reset(graph.nodeCount());
+    ws.relax(source, 0.0, -1);
+
+    while (!ws.isEmpty()) {
+        int u = ws.popMin();
+        if (u == target) {
+            break;
+        }
+        double du = ws.distance(u);
+        for (int a = graph.rowBegin(u); a < graph.rowEnd(u); ++a) {
+            ws.relax(graph.target(a), du + graph.weight(a), u);
+        }
+    }
+    return ws;
+}
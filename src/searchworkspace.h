@@ -0,0 +1,52 @@
+#ifndef SEARCHWORKSPACE_H
+#define SEARCHWORKSPACE_H
+
+#include <QVector>
+#include <QtGlobal>
+
+class CsrGraph;
+
+// Scratch state for one shortest-path search over dense stadium IDs: tentative
+// distances, predecessors and an indexed 4-ary min-heap with decrease-key.
+// Each thread keeps one workspace (local()) that is reused between searches;
+// reset() bumps a generation stamp instead of clearing the arrays, so entries
+// left over from an older search read back as "unreached".
+class SearchWorkspace {
+public:
+    static SearchWorkspace& local();
+
+    void reset(int nodeCount);
+
+    bool reached(int v) const { return stamp[v] == generation; }
+    bool settled(int v) const { return reached(v) && heapIndex[v] == Settled; }
+    double distance(int v) const;
+    int previous(int v) const { return reached(v) ? prev[v] : -1; }
+
+    // Lowers the tentative distance of v (inserting it if unseen) and records
+    // from as its predecessor. Returns false if d does not improve on v.
+    bool relax(int v, double d, int from);
+    bool isEmpty() const { return heap.isEmpty(); }
+    int popMin(); // removes and settles the closest queued node
+
+private:
+    static const int Arity = 4;
+    static const int Settled = -1;
+
+    void siftUp(int i);
+    void siftDown(int i);
+    void place(int i, int v) { heap[i] = v; heapIndex[v] = i; }
+
+    quint32 generation = 0;
+    QVector<quint32> stamp;  // generation in which dist/prev/heapIndex were written
+    QVector<double> dist;
+    QVector<int> prev;
+    QVector<int> heapIndex;  // position in heap, or Settled
+    QVector<int> heap;
+};
+
+// Heap-based Dijkstra from source over graph in this thread's workspace. Stops
+// early once target is settled (pass -1 to settle every reachable node). The
+// result stays valid until the next search on the same thread.
+const SearchWorkspace& shortestPathTree(const CsrGraph& graph, int source, int target = -1);
+
+#endif // SEARCHWORKSPACE_H
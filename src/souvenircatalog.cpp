@@ -0,0 +1,150 @@
+#include "souvenircatalog.h"
+
+void SouvenirCatalog::append(const QString &itemName, double price)
+{
+    items.append(qMakePair(itemName, price));
+}
+
+bool SouvenirCatalog::setPrice(const QString &itemName, double price)
+{
+    const int index = indexOf(itemName);
+    if (index < 0) {
+        return false;
+    }
+    items[index].second = price;
+    return true;
+}
+
+int SouvenirCatalog::indexOf(const QString &itemName) const
+{
+    for (int i = 0; i < items.size(); ++i) {
+        if (items[i].first == itemName) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+SouvenirList::SouvenirList(const QSharedPointer<const SouvenirCatalog> &catalog)
+    : catalog(catalog)
+{
+}
+
+void SouvenirList::addOverride(const QString &itemName, double price, bool hidden)
+{
+    const int index = overrideIndex(itemName);
+    if (index >= 0) {
+        overrides[index].price = price;
+        overrides[index].hidden = hidden;
+        return;
+    }
+    overrides.append({itemName, price, hidden});
+}
+
+QVector<Souvenir> SouvenirList::items() const
+{
+    QVector<Souvenir> result;
+    if (catalog) {
+        result.reserve(catalog->size() + overrides.size());
+        for (int i = 0; i < catalog->size(); ++i) {
+            const Souvenir &item = catalog->at(i);
+            const int index = overrideIndex(item.first);
+            if (index < 0) {
+                result.append(item);
+            } else if (!overrides[index].hidden) {
+                result.append(qMakePair(item.first, overrides[index].price));
+            }
+        }
+    }
+    for (const Override &item : overrides) {
+        if (!item.hidden && !inCatalog(item.itemName)) {
+            result.append(qMakePair(item.itemName, item.price));
+        }
+    }
+    return result;
+}
+
+int SouvenirList::size() const
+{
+    // Catalog items, less the ones this team hides, plus its own items
+    int count = catalog ? catalog->size() : 0;
+    for (const Override &item : overrides) {
+        if (inCatalog(item.itemName)) {
+            count -= item.hidden ? 1 : 0;
+        } else {
+            count += item.hidden ? 0 : 1;
+        }
+    }
+    return count;
+}
+
+bool SouvenirList::contains(const QString &itemName) const
+{
+    const int index = overrideIndex(itemName);
+    if (index >= 0) {
+        return !overrides[index].hidden;
+    }
+    return inCatalog(itemName);
+}
+
+double SouvenirList::price(const QString &itemName) const
+{
+    const int index = overrideIndex(itemName);
+    if (index >= 0) {
+        return overrides[index].hidden ? 0.0 : overrides[index].price;
+    }
+    const int catalogIndex = catalog ? catalog->indexOf(itemName) : -1;
+    return catalogIndex >= 0 ? catalog->at(catalogIndex).second : 0.0;
+}
+
+bool SouvenirList::hasOwnPrice(const QString &itemName) const
+{
+    const int index = overrideIndex(itemName);
+    return index >= 0 && !overrides[index].hidden;
+}
+
+bool SouvenirList::append(const QString &itemName, double price)
+{
+    if (contains(itemName)) {
+        return false;
+    }
+    addOverride(itemName, price, false);  // re-sells a hidden catalog item at this price
+    return true;
+}
+
+bool SouvenirList::setPrice(const QString &itemName, double price)
+{
+    if (!contains(itemName)) {
+        return false;
+    }
+    addOverride(itemName, price, false);
+    return true;
+}
+
+bool SouvenirList::remove(const QString &itemName)
+{
+    if (!contains(itemName)) {
+        return false;
+    }
+    if (inCatalog(itemName)) {
+        addOverride(itemName, 0.0, true);
+    } else {
+        overrides.removeAt(overrideIndex(itemName));
+    }
+    return true;
+}
+
+int SouvenirList::overrideIndex(const QString &itemName) const
+{
+    for (int i = 0; i < overrides.size(); ++i) {
+        if (overrides[i].itemName == itemName) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool SouvenirList::inCatalog(const QString &itemName) const
+{
+    return catalog && catalog->indexOf(itemName) >= 0;
+}
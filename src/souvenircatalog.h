@@ -0,0 +1,65 @@
+#ifndef SOUVENIRCATALOG_H
+#define SOUVENIRCATALOG_H
+
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+typedef QPair<QString, double> Souvenir;  // item name, price
+
+// Souvenirs every team sells, at one shared price. Held once and referenced
+// by every team's SouvenirList, the way souvenir_catalog is one row per item,
+// so a league-wide price change is a single update.
+class SouvenirCatalog {
+public:
+    void append(const QString &itemName, double price);
+    bool setPrice(const QString &itemName, double price);  // false if not a catalog item
+    int indexOf(const QString &itemName) const;            // -1 if not a catalog item
+    int size() const { return items.size(); }
+    const Souvenir &at(int index) const { return items.at(index); }
+
+private:
+    QVector<Souvenir> items;
+};
+
+// One team's souvenirs: the shared catalog adjusted by the team's own rows
+// in the souvenirs table, each of which is a different price for a catalog
+// item, a catalog item the team doesn't sell, or an item only it sells. Only
+// those rows are stored per team.
+class SouvenirList {
+public:
+    SouvenirList() = default;  // no catalog: only the team's own items
+    explicit SouvenirList(const QSharedPointer<const SouvenirCatalog> &catalog);
+
+    // One souvenirs row, as loaded
+    void addOverride(const QString &itemName, double price, bool hidden);
+
+    // Catalog items in catalog order, then the team's own items in the order added
+    QVector<Souvenir> items() const;
+    int size() const;  // without building items()
+    bool contains(const QString &itemName) const;
+    double price(const QString &itemName) const;      // 0 if not sold
+    bool hasOwnPrice(const QString &itemName) const;  // sold, but not at the catalog price
+
+    // Same rules as the matching Database writes; false if the item is
+    // already sold (append) or not sold (setPrice, remove)
+    bool append(const QString &itemName, double price);
+    bool setPrice(const QString &itemName, double price);
+    bool remove(const QString &itemName);
+
+private:
+    struct Override {
+        QString itemName;
+        double price;
+        bool hidden;  // catalog item the team doesn't sell
+    };
+
+    int overrideIndex(const QString &itemName) const;
+    bool inCatalog(const QString &itemName) const;
+
+    QSharedPointer<const SouvenirCatalog> catalog;
+    QVector<Override> overrides;
+};
+
+#endif // SOUVENIRCATALOG_H
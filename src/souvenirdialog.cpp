@@ -1,10 +1,12 @@
 #include "souvenirdialog.h"
 #include "ui_souvenirdialog.h"
+#include "databaseservice.h"
 #include <QMessageBox>
 #include <QSqlError>
 #include <QDebug>
 #include <QSqlQuery>
 #include <QStyledItemDelegate>
+#include <QHash>
 
 SouvenirDialog::SouvenirDialog(Database* database, const QString& teamName, QWidget *parent)
     : QDialog(parent)
@@ -30,10 +32,15 @@ SouvenirDialog::~SouvenirDialog()
 }
 
 void SouvenirDialog::loadSouvenirs()
+{
+    db->async()->getSouvenirs(teamName).then(this, [this](const QVector<QPair<QString, double>>& souvenirs) {
+        showSouvenirs(souvenirs);
+    });
+}
+
+void SouvenirDialog::showSouvenirs(const QVector<QPair<QString, double>>& souvenirs)
 {
     ui->souvenirTable->setRowCount(0);
-    QVector<QPair<QString, double>> souvenirs = db->getSouvenirs(teamName);
-    
     for (const auto& souvenir : souvenirs) {
         int row = ui->souvenirTable->rowCount();
         ui->souvenirTable->insertRow(row);
@@ -89,39 +96,76 @@ void SouvenirDialog::on_deleteButton_clicked()
         int row = selectedItems.first()->row();
         QString itemName = ui->souvenirTable->item(row, 0)->text();
         
-        if (db->deleteSouvenir(teamName, itemName)) {
-            ui->souvenirTable->removeRow(row);
-        } else {
-            QMessageBox::warning(this, tr("Error"),
-                               tr("Could not delete souvenir."));
-        }
+        db->async()->deleteSouvenir(teamName, itemName).then(this, [this, itemName](const QueryResult& result) {
+            if (!result.ok()) {
+                QMessageBox::warning(this, tr("Error"),
+                                   tr("Could not delete souvenir."));
+                return;
+            }
+            // Rows may have been added or removed while the delete ran
+            for (int r = 0; r < ui->souvenirTable->rowCount(); ++r) {
+                if (ui->souvenirTable->item(r, 0)->text() == itemName) {
+                    ui->souvenirTable->removeRow(r);
+                    break;
+                }
+            }
+        });
     }
 }
 
 void SouvenirDialog::on_closeButton_clicked()
 {
-    // Save any pending changes
+    // Save any pending changes through the service, then close
+    QVector<QPair<QString, double>> rows;
     for (int row = 0; row < ui->souvenirTable->rowCount(); ++row) {
-        QString itemName = ui->souvenirTable->item(row, 0)->text();
-        double price = ui->souvenirTable->item(row, 1)->text().toDouble();
-        
-        // Check if this is a new item or an existing one
-        bool exists = false;
-        QVector<QPair<QString, double>> existingSouvenirs = db->getSouvenirs(teamName);
-        for (const auto& souvenir : existingSouvenirs) {
-            if (souvenir.first == itemName) {
-                exists = true;
-                if (souvenir.second != price) {
-                    db->updateSouvenirPrice(teamName, itemName, price);
-                }
-                break;
+        rows.append(qMakePair(ui->souvenirTable->item(row, 0)->text(),
+                              ui->souvenirTable->item(row, 1)->text().toDouble()));
+    }
+    ui->closeButton->setEnabled(false);
+    const QString team = teamName;
+    // Read on the writer thread so it sees every edit queued before it
+    db->async()->write([team](Database& writer) {
+        return writer.getSouvenirs(team);
+    }).then(this, [this, rows](const QVector<QPair<QString, double>>& souvenirs) {
+        QHash<QString, double> existing;
+        for (const auto& souvenir : souvenirs) {
+            existing.insert(souvenir.first, souvenir.second);
+        }
+        QVector<QFuture<QueryResult>> saves;
+        QStringList items;
+        for (const auto& row : rows) {
+            // Check if this is a new item or an existing one
+            auto it = existing.constFind(row.first);
+            if (it == existing.constEnd()) {
+                saves.append(db->async()->addSouvenir(teamName, row.first, row.second));
+            } else if (it.value() != row.second) {
+                saves.append(db->async()->updateSouvenirPrice(teamName, row.first, row.second));
+            } else {
+                continue;
             }
+            items.append(row.first);
         }
-        
-        if (!exists) {
-            db->addSouvenir(teamName, itemName, price);
+        if (saves.isEmpty()) {
+            close();
+            return;
         }
-    }
-    
-    close();
-} 
\ No newline at end of file
+        // The writer runs jobs in order, so the others are done once the last one is
+        saves.last().then(this, [this, saves, items](const QueryResult&) {
+            QStringList failed;
+            for (int i = 0; i < saves.size(); ++i) {
+                const QueryResult result = saves[i].result();
+                if (!result.ok()) {
+                    qDebug() << "Error saving souvenir" << items[i] << ":" << result.error;
+                    failed.append(items[i]);
+                }
+            }
+            if (!failed.isEmpty()) {
+                QMessageBox::warning(this, tr("Error"),
+                                   tr("Could not save: %1").arg(failed.join(", ")));
+                ui->closeButton->setEnabled(true);
+                return;
+            }
+            close();
+        });
+    });
+}
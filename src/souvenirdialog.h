@@ -24,6 +24,7 @@ private slots:
 
 private:
     void loadSouvenirs();
+    void showSouvenirs(const QVector<QPair<QString, double>>& souvenirs);
     Ui::SouvenirDialog *ui;
     Database* db;
     QString teamName;
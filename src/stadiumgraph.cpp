@@ -1,48 +1,120 @@
 #include <QSet>
 #include <QQueue>
-#include <QFile>
-#include <QTextStream>
 #include <QDebug>
-#include <QRegularExpression>
+#include <QMutexLocker>
 #include <QtGlobal>
 #include <algorithm>
+#include <numeric>
+#include <limits>
 #include <queue>
-#include <functional>
 #include "stadiumgraph.h"
 #include "database.h"
+#include "tourimprover.h"
+#include "optimaltour.h"
+#include "disjointset.h"
+#include "distancecsv.h"
 
 StadiumGraph::StadiumGraph() {}
 
 QString StadiumGraph::normalizeStadiumName(const QString& name) {
-    if (name.trimmed().isEmpty()) {
-        qDebug() << "normalizeStadiumName: Empty or whitespace-only name provided";
-        return QString();
-    }
-    QString n = name.trimmed().toLower();
-    // Replace all Unicode dashes with a standard dash
-    n.replace(QChar(0x2013), '-'); // en dash
-    n.replace(QChar(0x2014), '-'); // em dash
-    n.replace(QChar(0x2012), '-'); // figure dash
-    n.replace(QChar(0x2015), '-'); // horizontal bar
-    // Keep dashes and spaces, but remove other special characters
-    n.remove(QRegularExpression("[^a-z0-9\\s-]"));
-    // Replace multiple spaces with a single space
-    n = n.simplified();
+    QString n = StadiumNameIndex::normalize(name);
     if (n.isEmpty()) {
-        qDebug() << "normalizeStadiumName: Name became empty after normalization:" << name;
-        return QString();
+        qDebug() << "normalizeStadiumName: Name is empty after normalization:" << name;
     }
     return n;
 }
 
+quint64 StadiumGraph::edgeKey(int a, int b) {
+    if (a > b) {
+        std::swap(a, b);
+    }
+    return (quint64(quint32(a)) << 32) | quint32(b);
+}
+
+int StadiumGraph::stadiumId(QStringView name) const {
+    return stadiumNames.find(name);
+}
+
+int StadiumGraph::internStadium(const QString& normalized) {
+    int count = stadiumNames.size();
+    int id = stadiumNames.intern(normalized);
+    if (stadiumNames.size() != count) {
+        markModified();
+    }
+    return id;
+}
+
+bool StadiumGraph::hasStadium(const QString& name) const {
+    return stadiumId(name) >= 0;
+}
+
+void StadiumGraph::markModified() {
+    csrDirty.store(true, std::memory_order_release);
+    graphVersion.fetch_add(1, std::memory_order_acq_rel);
+}
+
+quint64 StadiumGraph::version() const {
+    return graphVersion.load(std::memory_order_acquire);
+}
+
+const CsrGraph& StadiumGraph::adjacency() const {
+    if (csrDirty.load(std::memory_order_acquire)) {
+        QMutexLocker locker(&csrMutex);
+        if (csrDirty.load(std::memory_order_relaxed)) {
+            QVector<CsrEdge> edges;
+            edges.reserve(edgeWeights.size());
+            for (auto it = edgeWeights.constBegin(); it != edgeWeights.constEnd(); ++it) {
+                edges.append({int(it.key() >> 32), int(it.key() & 0xffffffffu), it.value()});
+            }
+            csr.build(stadiumNames.size(), edges);
+
+            idsByName = QVector<int>(stadiumNames.size());
+            std::iota(idsByName.begin(), idsByName.end(), 0);
+            std::sort(idsByName.begin(), idsByName.end(), [this](int a, int b) {
+                return stadiumNames[a] < stadiumNames[b];
+            });
+
+            // Traversal order of each row: closest neighbor first, ties by name
+            QVector<int> nameRank(stadiumNames.size());
+            for (int r = 0; r < idsByName.size(); ++r) {
+                nameRank[idsByName[r]] = r;
+            }
+            arcsByWeight = QVector<int>(csr.arcCount());
+            std::iota(arcsByWeight.begin(), arcsByWeight.end(), 0);
+            for (int u = 0; u < csr.nodeCount(); ++u) {
+                std::sort(arcsByWeight.begin() + csr.rowBegin(u), arcsByWeight.begin() + csr.rowEnd(u),
+                          [&](int x, int y) {
+                              if (csr.weight(x) != csr.weight(y)) return csr.weight(x) < csr.weight(y);
+                              return nameRank[csr.target(x)] < nameRank[csr.target(y)];
+                          });
+            }
+            connectedStadiums = 0;
+            for (int u = 0; u < csr.nodeCount(); ++u) {
+                if (csr.degree(u) > 0) ++connectedStadiums;
+            }
+            csrDirty.store(false, std::memory_order_release);
+        }
+    }
+    return csr;
+}
+
+std::shared_ptr<const DistanceMatrix> StadiumGraph::allPairs() const {
+    QMutexLocker locker(&pairsMutex);
+    quint64 current = version();
+    if (!pairs || pairsVersion != current) {
+        pairs = std::make_shared<const DistanceMatrix>(adjacency());
+        pairsVersion = current;
+    }
+    // Callers keep their snapshot even if a later edit triggers a rebuild
+    return pairs;
+}
+
 void StadiumGraph::addStadium(const QString& name) {
     QString norm = normalizeStadiumName(name);
     if (norm.isEmpty()) {
         return;
     }
-    if (!adjMatrix.contains(norm)) {
-        adjMatrix[norm] = QMap<QString, double>();
-    }
+    internStadium(norm);
 }
 
 void StadiumGraph::addEdge(const QString& from, const QString& to, double distance) {
@@ -52,8 +124,6 @@ void StadiumGraph::addEdge(const QString& from, const QString& to, double distan
     // Strict validation of inputs
     if (nFrom.isEmpty() || nTo.isEmpty()) {
         qDebug() << "addEdge: Invalid stadium names - from:" << from << "to:" << to;
-        qDebug() << "  Normalized from:" << nFrom << "(hex):" << nFrom.toUtf8().toHex();
-        qDebug() << "  Normalized to:" << nTo << "(hex):" << nTo.toUtf8().toHex();
         return;
     }
 
@@ -62,438 +132,222 @@ void StadiumGraph::addEdge(const QString& from, const QString& to, double distan
         return;
     }
 
-    // Additional validation to prevent empty keys
-    if (nFrom.trimmed().isEmpty() || nTo.trimmed().isEmpty()) {
-        qDebug() << "addEdge: Empty or whitespace-only stadium names after normalization";
-        qDebug() << "  From:" << nFrom << "(hex):" << nFrom.toUtf8().toHex();
-        qDebug() << "  To:" << nTo << "(hex):" << nTo.toUtf8().toHex();
-        return;
-    }
-
-    // Add stadiums if they don't exist
-    if (!adjMatrix.contains(nFrom)) {
-        adjMatrix[nFrom] = QMap<QString, double>();
-    }
-    if (!adjMatrix.contains(nTo)) {
-        adjMatrix[nTo] = QMap<QString, double>();
-    }
-
-    // Validate the stadiums exist in the matrix
-    if (!adjMatrix.contains(nFrom) || !adjMatrix.contains(nTo)) {
-        qDebug() << "addEdge: Failed to add stadiums to matrix - from:" << nFrom << "to:" << nTo;
-        return;
-    }
-
-    // Add the edges
-    adjMatrix[nFrom][nTo] = distance;
-    adjMatrix[nTo][nFrom] = distance;
+    addNormalizedEdge(nFrom, nTo, distance);
+}
 
-    // Verify the edges were added correctly
-    if (!adjMatrix[nFrom].contains(nTo) || !adjMatrix[nTo].contains(nFrom)) {
-        qDebug() << "addEdge: Failed to add edges - from:" << nFrom << "to:" << nTo;
-        return;
+bool StadiumGraph::addNormalizedEdge(const QString& nFrom, const QString& nTo, double distance) {
+    if (nFrom == nTo) {
+        qDebug() << "addEdge: Ignoring self-loop for" << nFrom;
+        return false;
     }
 
-    qDebug() << "Added edge:" << nFrom << "<->" << nTo << ":" << distance;
+    // Add stadiums if they don't exist, then record the undirected edge
+    int a = internStadium(nFrom);
+    int b = internStadium(nTo);
+    edgeWeights.insert(edgeKey(a, b), distance);
+    markModified();
+    return true;
 }
 
 double StadiumGraph::getDistance(const QString& from, const QString& to) const {
-    QString nFrom = normalizeStadiumName(from);
-    QString nTo = normalizeStadiumName(to);
-    if (adjMatrix.contains(nFrom) && adjMatrix[nFrom].contains(nTo)) {
-        return adjMatrix[nFrom][nTo];
+    int a = stadiumId(from);
+    int b = stadiumId(to);
+    if (a < 0 || b < 0) {
+        return -1.0;
     }
-    return -1.0;
+    return adjacency().weightBetween(a, b);
 }
 
 QVector<QString> StadiumGraph::getStadiums() const {
-    return adjMatrix.keys().toVector();
+    adjacency();
+    QVector<QString> names;
+    names.reserve(idsByName.size());
+    for (int id : idsByName) {
+        names.append(stadiumNames[id]);
+    }
+    return names;
 }
 
 QVector<QPair<QString, double>> StadiumGraph::getNeighbors(const QString& stadium) const {
     QVector<QPair<QString, double>> neighbors;
-    if (adjMatrix.contains(stadium)) {
-        for (auto it = adjMatrix[stadium].begin(); it != adjMatrix[stadium].end(); ++it) {
-            neighbors.append(qMakePair(it.key(), it.value()));
-        }
+    int u = stadiumId(stadium);
+    if (u < 0) {
+        return neighbors;
+    }
+    const CsrGraph& g = adjacency();
+    for (int a = g.rowBegin(u); a < g.rowEnd(u); ++a) {
+        neighbors.append(qMakePair(stadiumNames[g.target(a)], g.weight(a)));
     }
     return neighbors;
 }
 
 double StadiumGraph::dijkstra(const QString& start, const QString& end, QVector<QString>& path) const {
-    try {
-        QString nStart = normalizeStadiumName(start);
-        QString nEnd = normalizeStadiumName(end);
-        
-        if (nStart.isEmpty() || nEnd.isEmpty()) {
-            path.clear();
+    path.clear();
+    int s = stadiumId(start);
+    int t = stadiumId(end);
+    if (s < 0 || t < 0) {
         return -1.0;
     }
 
-        if (!adjMatrix.contains(nStart) || !adjMatrix.contains(nEnd)) {
-            path.clear();
-            return -1.0;
-        }
-
-    QMap<QString, double> distances;
-    QMap<QString, QString> previous;
-    QSet<QString> unvisited;
-    
-    for (const QString& stadium : adjMatrix.keys()) {
-            if (stadium.trimmed().isEmpty()) {
-                continue;
-            }
-        distances[stadium] = std::numeric_limits<double>::infinity();
-        unvisited.insert(stadium);
-    }
-        
-        distances[nStart] = 0;
-
-        int iterationCount = 0;
-        const int MAX_ITERATIONS = adjMatrix.size() * 2;
-
-        while (!unvisited.isEmpty() && iterationCount < MAX_ITERATIONS) {
-            iterationCount++;
-            
-        QString current;
-        double minDist = std::numeric_limits<double>::infinity();
-            
-        for (const QString& stadium : unvisited) {
-                if (!distances.contains(stadium)) {
-                    continue;
-                }
-            if (distances[stadium] < minDist) {
-                minDist = distances[stadium];
-                current = stadium;
-            }
-        }
-
-            if (current.isEmpty()) {
-                break;
-            }
-            
-            if (current == nEnd) {
-                break;
-        }
-
-        unvisited.remove(current);
-
-            if (!adjMatrix.contains(current)) {
-                break;
-            }
-            
-            const auto& neighbors = adjMatrix[current];
-            
-            for (auto it = neighbors.begin(); it != neighbors.end(); ++it) {
-            const QString& neighbor = it.key();
-                
-                if (neighbor.trimmed().isEmpty()) {
-                    continue;
-                }
-                
-                if (!adjMatrix.contains(neighbor)) {
-                    continue;
-                }
-                
-                if (!unvisited.contains(neighbor)) {
-                    continue;
-                }
-                
-                if (!distances.contains(neighbor)) {
-                    continue;
-                }
-                
-                double edgeWeight = it.value();
-                if (edgeWeight <= 0) {
-                    continue;
-                }
-                
-                double alt = distances[current] + edgeWeight;
-                if (alt < distances[neighbor]) {
-                    distances[neighbor] = alt;
-                    previous[neighbor] = current;
-                }
-            }
-        }
-
-        path.clear();
-        if (!distances.contains(nEnd) || distances[nEnd] == std::numeric_limits<double>::infinity()) {
-            return -1.0;
-        }
-        
-        QString current = nEnd;
-        QSet<QString> visitedForLoop;
-        int pathLength = 0;
-        const int MAX_PATH_LENGTH = adjMatrix.size() + 1;
-        
-        while (current != nStart && pathLength < MAX_PATH_LENGTH) {
-            if (visitedForLoop.contains(current)) {
-    path.clear();
-                return -1.0;
+    std::shared_ptr<const DistanceMatrix> matrix = allPairs();
+    if (!matrix->reachable(s, t)) {
+        return -1.0;
     }
-
-            visitedForLoop.insert(current);
-        path.prepend(current);
-            pathLength++;
-            
-            if (!previous.contains(current)) {
-                path.clear();
-                return -1.0;
-            }
-            
-        current = previous[current];
+    for (int id : matrix->path(s, t)) {
+        path.append(stadiumNames[id]);
     }
-        
-        if (pathLength >= MAX_PATH_LENGTH) {
-            path.clear();
-            return -1.0;
-        }
-        
-        path.prepend(nStart);
-        
-        if (path.isEmpty() || path.first() != nStart || path.last() != nEnd) {
-            path.clear();
-            return -1.0;
-        }
+    return matrix->distance(s, t);
+}
 
-        return distances[nEnd];
-        
-    } catch (...) {
-        path.clear();
+double StadiumGraph::shortestDistance(const QString& from, const QString& to) const {
+    int s = stadiumId(from);
+    int t = stadiumId(to);
+    if (s < 0 || t < 0) {
         return -1.0;
     }
+    std::shared_ptr<const DistanceMatrix> matrix = allPairs();
+    return matrix->reachable(s, t) ? matrix->distance(s, t) : -1.0;
 }
 
 double StadiumGraph::aStar(const QString& start, const QString& end, QVector<QString>& path) const {
-    if (!adjMatrix.contains(start) || !adjMatrix.contains(end)) {
-        return -1.0;
-    }
-
-    // Priority queue for open set (f_score, stadium)
-    QMap<double, QSet<QString>> openSet;
-    QSet<QString> closedSet;
-    QMap<QString, double> g_score;  // Cost from start to current
-    QMap<QString, double> f_score;  // Estimated total cost
-    QMap<QString, QString> came_from;
-
-    // Initialize scores
-    for (const QString& stadium : adjMatrix.keys()) {
-        g_score[stadium] = std::numeric_limits<double>::infinity();
-        f_score[stadium] = std::numeric_limits<double>::infinity();
-    }
-    g_score[start] = 0;
-    f_score[start] = 0;  // For start node, f_score = g_score since h_score = 0
-    openSet[0].insert(start);
-
-    while (!openSet.isEmpty()) {
-        // Get stadium with lowest f_score
-        double current_f = openSet.firstKey();
-        QString current = *openSet[current_f].begin();
-        openSet[current_f].remove(current);
-        if (openSet[current_f].isEmpty()) {
-            openSet.remove(current_f);
-        }
-
-        if (current == end) {
-            // Reconstruct path
-            path.clear();
-            while (current != start) {
-                path.prepend(current);
-                current = came_from[current];
-            }
-            path.prepend(start);
-            return g_score[end];
-        }
-
-        closedSet.insert(current);
-
-        // Check all neighbors
-        for (auto it = adjMatrix[current].begin(); it != adjMatrix[current].end(); ++it) {
-            const QString& neighbor = it.key();
-            if (closedSet.contains(neighbor)) {
-                continue;
-            }
-
-            double tentative_g_score = g_score[current] + it.value();
-
-            if (tentative_g_score < g_score[neighbor]) {
-                came_from[neighbor] = current;
-                g_score[neighbor] = tentative_g_score;
-                f_score[neighbor] = g_score[neighbor];  // f_score = g_score since we don't have heuristic
-
-                // Add to open set
-                openSet[f_score[neighbor]].insert(neighbor);
-            }
-        }
+    // There is no admissible heuristic between stadiums (h = 0), so A* is Dijkstra
+    return dijkstra(start, end, path);
+}
+
+std::shared_ptr<const QVector<CsrEdge>> StadiumGraph::edgesByWeight() const {
+    QMutexLocker locker(&pairsMutex);
+    quint64 current = version();
+    if (!sortedEdges || sortedEdgesVersion != current) {
+        auto edges = std::make_shared<QVector<CsrEdge>>();
+        edges->reserve(edgeWeights.size());
+        for (auto it = edgeWeights.constBegin(); it != edgeWeights.constEnd(); ++it) {
+            edges->append({int(it.key() >> 32), int(it.key() & 0xffffffffu), it.value()});
+        }
+        // Ties are broken by ID so the forest does not depend on hash order
+        std::sort(edges->begin(), edges->end(), [](const CsrEdge& x, const CsrEdge& y) {
+            if (x.weight != y.weight) return x.weight < y.weight;
+            if (x.from != y.from) return x.from < y.from;
+            return x.to < y.to;
+        });
+        sortedEdges = edges;
+        sortedEdgesVersion = current;
     }
-
-    return -1.0;  // No path found
+    return sortedEdges;
 }
 
-double StadiumGraph::minimumSpanningTree(QVector<QPair<QString, QString>>& mstEdges) const {
+double StadiumGraph::minimumSpanningTree(QVector<QPair<QString, QString>>& mstEdges, int* componentCount) const {
     mstEdges.clear();
-    if (adjMatrix.isEmpty()) {
+    const int n = stadiumNames.size();
+    if (componentCount) {
+        *componentCount = n;
+    }
+    if (n == 0) {
         qDebug() << "MST: Empty graph";
         return 0.0;
     }
 
-    // Verify graph is connected
-    if (!isConnected()) {
-        qDebug() << "MST: Graph is not connected";
-        return -1.0;
-    }
-
-    // Clean up any empty keys or neighbors before starting
-    QMap<QString, QMap<QString, double>> cleanAdjMatrix;
-    for (auto it = adjMatrix.begin(); it != adjMatrix.end(); ++it) {
-        QString stadium = it.key();
-        if (stadium.trimmed().isEmpty()) {
-            qDebug() << "MST: Skipping empty stadium name";
+    // Kruskal over the edges sorted once per graph version. A disconnected graph
+    // simply yields a spanning forest, one tree per component.
+    std::shared_ptr<const QVector<CsrEdge>> edges = edgesByWeight();
+    DisjointSet components(n);
+    double totalWeight = 0.0;
+    for (const CsrEdge& e : *edges) {
+        if (!components.unite(e.from, e.to)) {
             continue;
         }
-        QMap<QString, double> cleanNeighbors;
-        for (auto nIt = it.value().begin(); nIt != it.value().end(); ++nIt) {
-            QString neighbor = nIt.key();
-            if (neighbor.trimmed().isEmpty()) {
-                qDebug() << "MST: Skipping empty neighbor for" << stadium;
-                continue;
-            }
-            if (nIt.value() <= 0) {
-                qDebug() << "MST: Skipping invalid distance for" << stadium << "->" << neighbor;
-                continue;
-            }
-            cleanNeighbors[neighbor] = nIt.value();
-        }
-        if (!cleanNeighbors.isEmpty()) {
-            cleanAdjMatrix[stadium] = cleanNeighbors;
+        mstEdges.append(qMakePair(stadiumNames[e.from], stadiumNames[e.to]));
+        totalWeight += e.weight;
+        if (components.setCount() == 1) {
+            break;
         }
     }
 
-    if (cleanAdjMatrix.isEmpty()) {
-        qDebug() << "MST: No valid edges after cleaning";
-        return -1.0;
+    if (componentCount) {
+        *componentCount = components.setCount();
     }
-
-    QSet<QString> visited;
-    QMap<QString, double> key;
-    QMap<QString, QString> parent;
-    double totalWeight = 0.0;
-
-    // Initialize keys to infinity
-    for (const QString& stadium : cleanAdjMatrix.keys()) {
-        key[stadium] = std::numeric_limits<double>::infinity();
+    if (components.setCount() > 1) {
+        qDebug() << "MST: Graph has" << components.setCount() << "components, returning a spanning forest";
     }
+    qDebug() << "MST:" << mstEdges.size() << "edges, total weight" << totalWeight;
+    return totalWeight;
+}
 
-    // Start with first stadium
-    QString start = cleanAdjMatrix.firstKey();
-    key[start] = 0;
-
-    while (visited.size() < cleanAdjMatrix.size()) {
-        // Find unvisited vertex with minimum key
-        QString current;
-        double minKey = std::numeric_limits<double>::infinity();
-        
-        for (const QString& stadium : cleanAdjMatrix.keys()) {
-            if (!visited.contains(stadium) && key[stadium] < minKey) {
-                minKey = key[stadium];
-                current = stadium;
+// Iterative DFS with an explicit stack of (stadium, next arc) frames, visiting
+// neighbors closest first. steps[0] is the start (from = -1); every other step
+// is the discovery edge that reached its stadium.
+void StadiumGraph::depthFirst(int start, QVector<TraversalStep>& steps) const {
+    const CsrGraph& g = adjacency();
+    QVector<bool> visited(g.nodeCount(), false);
+    QVector<QPair<int, int>> stack;
+    stack.reserve(g.nodeCount());
+    steps.clear();
+    steps.append({-1, start, 0.0});
+    visited[start] = true;
+    stack.append(qMakePair(start, g.rowBegin(start)));
+
+    while (!stack.isEmpty()) {
+        QPair<int, int>& frame = stack.last();
+        const int u = frame.first;
+        int next = -1;
+        while (frame.second < g.rowEnd(u)) {
+            int arc = arcsByWeight[frame.second++];
+            if (!visited[g.target(arc)]) {
+                next = arc;
+                break;
             }
         }
-
-        if (minKey == std::numeric_limits<double>::infinity() || current.isEmpty()) {
-            qDebug() << "MST: No valid unvisited vertex found";
-            mstEdges.clear();
-            return -1.0;
+        if (next < 0) {
+            stack.removeLast();
+            continue;
         }
+        const int v = g.target(next);
+        visited[v] = true;
+        steps.append({u, v, g.weight(next)});
+        stack.append(qMakePair(v, g.rowBegin(v)));
+    }
+}
 
-        visited.insert(current);
+// BFS with neighbors enqueued closest first; steps doubles as the queue
+void StadiumGraph::breadthFirst(int start, QVector<TraversalStep>& steps) const {
+    const CsrGraph& g = adjacency();
+    QVector<bool> visited(g.nodeCount(), false);
+    steps.clear();
+    steps.reserve(g.nodeCount());
+    steps.append({-1, start, 0.0});
+    visited[start] = true;
 
-        // Add edge to MST if not the first vertex
-        if (current != start) {
-            if (!parent.contains(current)) {
-                qDebug() << "MST: No parent found for" << current;
-                continue;
-            }
-            const QString& parentStadium = parent[current];
-            if (!cleanAdjMatrix.contains(parentStadium) || !cleanAdjMatrix.contains(current)) {
-                qDebug() << "MST: Parent or current stadium not in clean graph";
-                continue;
-            }
-            mstEdges.append(qMakePair(parentStadium, current));
-            totalWeight += key[current];
-            qDebug() << "MST added edge:" << parentStadium << "<->" << current 
-                     << "weight:" << key[current];
-        }
-
-        // Update keys of adjacent vertices
-        for (auto it = cleanAdjMatrix[current].begin(); it != cleanAdjMatrix[current].end(); ++it) {
-            const QString& neighbor = it.key();
-            if (!visited.contains(neighbor) && it.value() < key[neighbor]) {
-                parent[neighbor] = current;
-                key[neighbor] = it.value();
+    for (int head = 0; head < steps.size(); ++head) {
+        const int u = steps[head].to;
+        for (int a = g.rowBegin(u); a < g.rowEnd(u); ++a) {
+            int arc = arcsByWeight[a];
+            int v = g.target(arc);
+            if (!visited[v]) {
+                visited[v] = true;
+                steps.append({u, v, g.weight(arc)});
             }
         }
     }
-
-    // Verify MST has correct number of edges
-    if (mstEdges.size() != cleanAdjMatrix.size() - 1) {
-        qDebug() << "MST: Incorrect number of edges. Expected:" << (cleanAdjMatrix.size() - 1)
-                 << "Got:" << mstEdges.size();
-        mstEdges.clear();
-        return -1.0;
-    }
-
-    return totalWeight;
 }
 
-void StadiumGraph::dfsUtil(const QString& current, QSet<QString>& visited, QVector<QString>& order, double& totalDistance, const QString& prev) const {
-    visited.insert(current);
-    order.append(current);
-    if (!prev.isEmpty()) {
-        totalDistance += getDistance(prev, current);
-    }
-    
-    // Get all unvisited neighbors with their distances
-    QVector<QPair<QString, double>> unvisitedNeighbors;
-    for (auto it = adjMatrix[current].begin(); it != adjMatrix[current].end(); ++it) {
-        QString neighbor = it.key();
-        if (!visited.contains(neighbor)) {
-            unvisitedNeighbors.append(qMakePair(neighbor, it.value()));
-        }
-    }
-    
-    // Sort neighbors by distance (shortest first)
-    std::sort(unvisitedNeighbors.begin(), unvisitedNeighbors.end(),
-              [](const QPair<QString, double>& a, const QPair<QString, double>& b) {
-                  return a.second < b.second;
-              });
-    
-    // Visit neighbors in order of increasing distance
-    for (const auto& neighbor : unvisitedNeighbors) {
-        dfsUtil(neighbor.first, visited, order, totalDistance, current);
-    }
+int StadiumGraph::connectedStadiumCount() const {
+    adjacency();
+    return connectedStadiums;
 }
 
 double StadiumGraph::dfs(const QString& start, QVector<QString>& order) const {
     order.clear();
-    QString nStart = normalizeStadiumName(start);
-    if (nStart.isEmpty() || !adjMatrix.contains(nStart)) return -1.0;
-    QSet<QString> visited;
+    int s = stadiumId(start);
+    if (s < 0) return -1.0;
+    QVector<TraversalStep> steps;
+    depthFirst(s, steps);
     double totalDistance = 0.0;
-    dfsUtil(nStart, visited, order, totalDistance, "");
-    if (order.size() == adjMatrix.size()) {
-        // Debug output: print order and distances
-        qDebug() << "DFS Order:";
-        for (int i = 0; i < order.size(); ++i) {
-            qDebug() << i+1 << ":" << order[i];
-        }
-        qDebug() << "DFS Step Distances:";
-        double runningTotal = 0.0;
-        for (int i = 1; i < order.size(); ++i) {
-            double dist = getDistance(order[i-1], order[i]);
-            runningTotal += dist;
-            qDebug() << order[i-1] << "->" << order[i] << ":" << dist << ", running total:" << runningTotal;
-                }
+    for (const TraversalStep& step : steps) {
+        order.append(stadiumNames[step.to]);
+        totalDistance += step.miles;
+    }
+    // Stadiums without any edge can never be reached, so they do not count
+    if (order.size() == connectedStadiumCount()) {
+        qDebug() << "DFS Order:" << order;
         qDebug() << "DFS Total Distance:" << totalDistance;
         return totalDistance;
     } else {
@@ -502,69 +356,21 @@ double StadiumGraph::dfs(const QString& start, QVector<QString>& order) const {
 }
 
 double StadiumGraph::bfs(const QString& start, QVector<QString>& order) const {
-    // Force cleaning before BFS
-    const_cast<StadiumGraph*>(this)->cleanAdjacencyMatrix();
-    
     order.clear();
-    QString nStart = normalizeStadiumName(start);
-    if (nStart.isEmpty() || !adjMatrix.contains(nStart)) {
+    int s = stadiumId(start);
+    if (s < 0) {
         qDebug() << "BFS: Invalid start stadium:" << start;
         return -1.0;
     }
 
-    QSet<QString> visited;
-    QQueue<QString> queue;
+    QVector<TraversalStep> steps;
+    breadthFirst(s, steps);
     double totalDistance = 0.0;
-    visited.insert(nStart);
-    queue.enqueue(nStart);
-    order.append(nStart);
-    int maxIterations = adjMatrix.size() * 10;
-    int iterations = 0;
-
-    while (!queue.isEmpty()) {
-        if (++iterations > maxIterations) {
-            break;
-        }
-        QString current = queue.dequeue();
-        if (!adjMatrix.contains(current)) {
-            continue;
-        }
-        const QMap<QString, double>& currentNeighbors = adjMatrix[current];
-        QVector<QPair<QString, double>> unvisitedNeighbors;
-        for (auto it = currentNeighbors.begin(); it != currentNeighbors.end(); ++it) {
-            QString neighbor = it.key();
-            if (neighbor.trimmed().isEmpty()) {
-                continue;
-            }
-            if (!adjMatrix.contains(neighbor)) {
-                continue;
-            }
-            if (visited.contains(neighbor)) {
-                continue;
-            }
-            double distance = it.value();
-            if (distance <= 0) {
-                continue;
-            }
-            unvisitedNeighbors.append(qMakePair(neighbor, distance));
-        }
-        std::sort(unvisitedNeighbors.begin(), unvisitedNeighbors.end(),
-                  [](const QPair<QString, double>& a, const QPair<QString, double>& b) {
-                      return a.second < b.second;
-                  });
-        for (const auto& neighbor : unvisitedNeighbors) {
-            const QString& nextStadium = neighbor.first;
-            double distance = neighbor.second;
-            if (nextStadium.trimmed().isEmpty() || !adjMatrix.contains(nextStadium)) {
-                continue;
-            }
-            visited.insert(nextStadium);
-            queue.enqueue(nextStadium);
-            order.append(nextStadium);
-            totalDistance += distance;
-        }
+    for (const TraversalStep& step : steps) {
+        order.append(stadiumNames[step.to]);
+        totalDistance += step.miles;
     }
-    if (order.size() == adjMatrix.size()) {
+    if (order.size() == connectedStadiumCount()) {
         return totalDistance;
     } else {
         return -1.0;
@@ -572,81 +378,68 @@ double StadiumGraph::bfs(const QString& start, QVector<QString>& order) const {
 }
 
 double StadiumGraph::greedyTrip(const QString& start, const QVector<QString>& stops, QVector<QString>& order) const {
-    try {
-        // Validate inputs
-        QString nStart = normalizeStadiumName(start);
-        if (!adjMatrix.contains(nStart)) {
-            qDebug() << "Start stadium not found:" << start << "(normalized:" << nStart << ")";
+    // Validate inputs
+    int current = stadiumId(start);
+    if (current < 0) {
+        qDebug() << "Start stadium not found:" << start;
         return -1.0;
     }
-        if (stops.isEmpty()) {
-            qDebug() << "No stops provided for trip";
-            return -1.0;
+    if (stops.isEmpty()) {
+        qDebug() << "No stops provided for trip";
+        return -1.0;
+    }
+    const CsrGraph& g = adjacency();
+
+    // Verify all stops exist in the graph
+    QVector<int> unvisited;
+    for (const QString& stop : stops) {
+        int id = stadiumId(stop);
+        if (id < 0) {
+            qDebug() << "Stop stadium not found:" << stop;
+            continue; // skip missing stadiums
+        }
+        if (!unvisited.contains(id)) {
+            unvisited.append(id);
         }
-        // Verify all stops exist in the graph
-        QVector<QString> normalizedStops;
-        for (const QString& stop : stops) {
-            QString nStop = normalizeStadiumName(stop);
-            if (!adjMatrix.contains(nStop)) {
-                qDebug() << "Stop stadium not found:" << stop << "(normalized:" << nStop << ")";
-                continue; // skip missing stadiums
-            }
-            normalizedStops.append(nStop);
     }
-        QSet<QString> unvisited(normalizedStops.begin(), normalizedStops.end());
     order.clear();
-        order.append(nStart);
+    order.append(stadiumNames[current]);
     double totalDistance = 0.0;
-        QString current = nStart;
-        QVector<QString> skipped;
     while (!unvisited.isEmpty()) {
         // Find nearest unvisited stadium
-        QString nearest;
+        int nearest = -1;
         double minDist = std::numeric_limits<double>::infinity();
-        for (const QString& stop : unvisited) {
-                try {
-            double dist = getDistance(current, stop);
+        for (int i = 0; i < unvisited.size(); ++i) {
+            double dist = g.weightBetween(current, unvisited[i]);
             if (dist >= 0 && dist < minDist) {
                 minDist = dist;
-                nearest = stop;
-                    }
-                } catch (...) {
-                    continue;
+                nearest = i;
             }
         }
-        if (minDist == std::numeric_limits<double>::infinity()) {
-                // No reachable stadiums left from current
-                // Remove all remaining unvisited stadiums as skipped
-                for (const QString& s : unvisited) skipped.append(s);
-                break;
+        if (nearest < 0) {
+            // No reachable stadiums left from current
+            QVector<QString> skipped;
+            for (int id : unvisited) skipped.append(stadiumNames[id]);
+            qDebug() << "Skipped unreachable stadiums in greedyTrip:" << skipped;
+            break;
         }
         // Move to nearest stadium
-        current = nearest;
-        unvisited.remove(current);
-        order.append(current);
+        current = unvisited.takeAt(nearest);
+        order.append(stadiumNames[current]);
         totalDistance += minDist;
-            qDebug() << "Added to trip:" << current << "Distance:" << minDist;
+        qDebug() << "Added to trip:" << stadiumNames[current] << "Distance:" << minDist;
     }
-        if (!skipped.isEmpty()) {
-            qDebug() << "Skipped unreachable stadiums in greedyTrip:" << skipped;
-        }
-        qDebug() << "Trip planning complete. Total distance:" << totalDistance;
+    qDebug() << "Trip planning complete. Total distance:" << totalDistance;
     return totalDistance;
-    } catch (const std::exception& e) {
-        qDebug() << "Error in greedyTrip:" << e.what();
-        return -1.0;
-    } catch (...) {
-        qDebug() << "Unknown error in greedyTrip";
-        return -1.0;
-    }
 }
 
 void StadiumGraph::debugPrintAllEdges() const {
     qDebug() << "All edges in StadiumGraph:";
-    for (const auto& from : adjMatrix.keys()) {
-        for (const auto& to : adjMatrix[from].keys()) {
-            if (from < to) { // avoid duplicate undirected edges
-                qDebug() << from << "->" << to << ":" << adjMatrix[from][to];
+    const CsrGraph& g = adjacency();
+    for (int u = 0; u < g.nodeCount(); ++u) {
+        for (int a = g.rowBegin(u); a < g.rowEnd(u); ++a) {
+            if (u < g.target(a)) { // avoid duplicate undirected edges
+                qDebug() << stadiumNames[u] << "->" << stadiumNames[g.target(a)] << ":" << g.weight(a);
             }
         }
     }
@@ -654,45 +447,32 @@ void StadiumGraph::debugPrintAllEdges() const {
 
 void StadiumGraph::debugPrintAllNormalizedStadiums() const {
     qDebug() << "All normalized stadium names in StadiumGraph:";
-    for (const QString& stadium : adjMatrix.keys()) {
+    for (const QString& stadium : getStadiums()) {
         qDebug() << stadium;
     }
 }
 
 void StadiumGraph::debugPrintAllStadiumConnections() const {
-    try {
-        qDebug() << "\n=== Stadium Connections ===";
-        for (const QString& stadium : adjMatrix.keys()) {
-            try {
-                QStringList connections;
-                if (adjMatrix.contains(stadium)) {
-                    for (auto it = adjMatrix[stadium].begin(); it != adjMatrix[stadium].end(); ++it) {
-                        connections << QString("%1 (%2)").arg(it.key()).arg(it.value());
-                    }
-                    qDebug() << stadium << ":" << connections.join(", ");
-                }
-            } catch (const std::exception& e) {
-                qDebug() << "Error processing connections for stadium" << stadium << ":" << e.what();
-            } catch (...) {
-                qDebug() << "Unknown error processing connections for stadium" << stadium;
-            }
+    qDebug() << "\n=== Stadium Connections ===";
+    const CsrGraph& g = adjacency();
+    for (int u : idsByName) {
+        QStringList connections;
+        for (int a = g.rowBegin(u); a < g.rowEnd(u); ++a) {
+            connections << QString("%1 (%2)").arg(stadiumNames[g.target(a)]).arg(g.weight(a));
         }
-    } catch (const std::exception& e) {
-        qDebug() << "Error in debugPrintAllStadiumConnections:" << e.what();
-    } catch (...) {
-        qDebug() << "Unknown error in debugPrintAllStadiumConnections";
+        qDebug() << stadiumNames[u] << ":" << connections.join(", ");
     }
 }
 
 void StadiumGraph::debugPrintMissingEdges() const {
     qDebug() << "\n=== Missing Edges (distance -1) ===";
-    QVector<QString> stadiums = getStadiums();
+    const CsrGraph& g = adjacency();
+    const int n = g.nodeCount();
     int missingCount = 0;
-    for (int i = 0; i < stadiums.size(); ++i) {
-        for (int j = i + 1; j < stadiums.size(); ++j) {
-            double dist = getDistance(stadiums[i], stadiums[j]);
-            if (dist == -1.0) {
-                qDebug() << stadiums[i] << "<->" << stadiums[j] << ": -1 (missing)";
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            if (g.weightBetween(i, j) == -1.0) {
+                qDebug() << stadiumNames[i] << "<->" << stadiumNames[j] << ": -1 (missing)";
                 ++missingCount;
             }
         }
@@ -705,215 +485,83 @@ void StadiumGraph::debugPrintMissingEdges() const {
 }
 
 void StadiumGraph::removeEmptyKeysAndNeighbors() {
-    // Remove any empty or whitespace-only keys from adjMatrix
-    QList<QString> badKeys;
-    for (const QString& key : adjMatrix.keys()) {
-        if (key.trimmed().isEmpty()) {
-            badKeys.append(key);
-        }
-    }
-    for (const QString& key : badKeys) {
-        adjMatrix.remove(key);
-        qDebug() << "Removed empty or whitespace-only key from adjMatrix!";
-    }
-    // Remove any empty or whitespace-only neighbors for all stadiums
-    for (auto it = adjMatrix.begin(); it != adjMatrix.end(); ++it) {
-        QList<QString> badNeighbors;
-        for (const QString& nKey : it.value().keys()) {
-            if (nKey.trimmed().isEmpty()) {
-                badNeighbors.append(nKey);
-            }
-        }
-        for (const QString& nKey : badNeighbors) {
-            it.value().remove(nKey);
-            qDebug() << "Removed empty or whitespace-only neighbor for" << it.key();
-        }
-    }
+    // Empty or whitespace-only names are rejected by normalizeStadiumName before they
+    // ever get an ID, so there is nothing left to strip here.
 }
 
 void StadiumGraph::debugPrintAllNeighbors() const {
-    // Diagnostic: Print all keys for angelstadium at start
-    if (adjMatrix.contains("angelstadium")) {
-        qDebug() << "DEBUG: All keys for angelstadium at start of debugPrintAllNeighbors:";
-        const auto& angelNeighbors = adjMatrix["angelstadium"];
-        for (auto it = angelNeighbors.begin(); it != angelNeighbors.end(); ++it) {
-            QString key = it.key();
-            if (key.trimmed().isEmpty()) {
-                qDebug() << "WARNING: Found empty key in angelstadium neighbors!";
-                continue;
-            }
-            qDebug() << "[" << key << "]";
-        }
-    }
-    for (const QString& stadium : adjMatrix.keys()) {
-        if (stadium.trimmed().isEmpty()) {
-            qDebug() << "WARNING: Found empty or whitespace-only stadium name in adjMatrix keys, skipping.";
-            continue;
-        }
-        QByteArray stadiumHex = stadium.toUtf8().toHex();
-        const auto& neighbors = adjMatrix[stadium];
-        for (auto nIt = neighbors.begin(); nIt != neighbors.end(); ++nIt) {
-            QString neighbor = nIt.key();
-            if (neighbor.trimmed().isEmpty()) {
-                qDebug() << "WARNING: Found empty or whitespace-only neighbor key for stadium" << stadium << ". Skipping.";
-                continue;
-            }
-        }
+    const CsrGraph& g = adjacency();
+    for (int u : idsByName) {
+        qDebug() << stadiumNames[u] << "has" << g.degree(u) << "neighbors";
     }
 }
 
 bool StadiumGraph::validateGraphIntegrity() const {
     bool valid = true;
-    for (const QString& stadium : adjMatrix.keys()) {
-        QByteArray stadiumHex = stadium.toUtf8().toHex();
+    for (const QString& stadium : stadiumNames) {
         if (stadium.trimmed().isEmpty()) {
-            qCritical() << "FATAL: Found empty or whitespace-only stadium name in adjMatrix! Hex:" << stadiumHex;
+            qCritical() << "FATAL: Found empty or whitespace-only stadium name in graph! Hex:" << stadium.toUtf8().toHex();
             valid = false;
         }
-        for (const QString& neighbor : adjMatrix[stadium].keys()) {
-            QByteArray neighborHex = neighbor.toUtf8().toHex();
-            if (neighbor.trimmed().isEmpty()) {
-                qCritical() << "FATAL: Found empty or whitespace-only neighbor for" << stadium << "! Hex:" << neighborHex;
-                valid = false;
-            }
+    }
+    for (auto it = edgeWeights.constBegin(); it != edgeWeights.constEnd(); ++it) {
+        int a = int(it.key() >> 32);
+        int b = int(it.key() & 0xffffffffu);
+        if (a >= stadiumNames.size() || b >= stadiumNames.size() || it.value() <= 0) {
+            qCritical() << "FATAL: Found invalid edge" << a << "<->" << b << "distance:" << it.value();
+            valid = false;
         }
     }
     return valid;
 }
 
 void StadiumGraph::rebuildStadiumConnections(const QString& stadium) {
-    if (!adjMatrix.contains(stadium)) {
+    int id = stadiumId(stadium);
+    if (id < 0) {
         return;
     }
-
-    QMap<QString, double> validNeighbors;
-    const auto& currentNeighbors = adjMatrix[stadium];
-    
-    // Only keep neighbors that are non-empty and exist in the graph
-    for (auto it = currentNeighbors.begin(); it != currentNeighbors.end(); ++it) {
-        QString neighbor = it.key();
-        double distance = it.value();
-        
-        // Skip if neighbor is empty or doesn't exist in graph
-        if (neighbor.trimmed().isEmpty() || !adjMatrix.contains(neighbor)) {
-            qDebug() << "Rebuilding connections for" << stadium << ": Removing invalid neighbor" 
-                     << neighbor << "(hex):" << neighbor.toUtf8().toHex();
-            continue;
-        }
-        
-        // Skip if distance is invalid
-        if (distance <= 0) {
-            qDebug() << "Rebuilding connections for" << stadium << ": Removing neighbor with invalid distance" 
-                     << neighbor << "distance:" << distance;
-            continue;
-        }
-        
-        validNeighbors[neighbor] = distance;
-    }
-    
-    // Replace the stadium's connections with only valid ones
-    adjMatrix[stadium] = validNeighbors;
-    qDebug() << "Rebuilt connections for" << stadium << ":" << validNeighbors.size() << "valid neighbors";
+    // Edges are validated when they are added, so every stored neighbor is valid
+    qDebug() << "Rebuilt connections for" << stadium << ":" << adjacency().degree(id) << "valid neighbors";
 }
 
-void StadiumGraph::cleanAdjacencyMatrix() {
-    qDebug() << "\n=== Starting deep adjacency matrix cleaning ===";
-    QList<QString> emptyStadiums;
-    int removedNeighbors = 0;
-    int removedStadiums = 0;
-
-    // First pass: identify and remove empty stadiums
-    for (auto it = adjMatrix.begin(); it != adjMatrix.end(); ++it) {
-        QString stadium = it.key();
-        if (stadium.trimmed().isEmpty()) {
-            emptyStadiums.append(stadium);
-            qDebug() << "Found empty stadium name (hex):" << stadium.toUtf8().toHex();
-            continue;
-        }
+void StadiumGraph::removeIsolatedStadiums() {
+    QVector<int> degree(stadiumNames.size(), 0);
+    for (auto it = edgeWeights.constBegin(); it != edgeWeights.constEnd(); ++it) {
+        ++degree[int(it.key() >> 32)];
+        ++degree[int(it.key() & 0xffffffffu)];
+    }
+    if (!degree.contains(0)) {
+        return;
     }
 
-    // Remove empty stadiums
-    for (const QString& emptyStadium : emptyStadiums) {
-        adjMatrix.remove(emptyStadium);
-        removedStadiums++;
-        qDebug() << "Removed empty stadium:" << emptyStadium;
-    }
-
-    // Second pass: deep clean of all neighbors
-    QMap<QString, QMap<QString, double>> cleanMatrix;
-    for (auto it = adjMatrix.begin(); it != adjMatrix.end(); ++it) {
-        QString stadium = it.key();
-        QMap<QString, double> cleanNeighbors;
-        
-        // Validate each neighbor
-        for (auto nIt = it.value().begin(); nIt != it.value().end(); ++nIt) {
-            QString neighbor = nIt.key();
-            double distance = nIt.value();
-            
-            // Skip if neighbor is empty or doesn't exist in graph
-            if (neighbor.trimmed().isEmpty()) {
-                qDebug() << "Found empty neighbor for" << stadium << "(hex):" << neighbor.toUtf8().toHex();
-                removedNeighbors++;
-                continue;
-            }
-            
-            // Skip if neighbor doesn't exist in graph
-            if (!adjMatrix.contains(neighbor)) {
-                qDebug() << "Found neighbor not in graph:" << neighbor << "for stadium:" << stadium;
-                removedNeighbors++;
-                continue;
-            }
-            
-            // Skip if distance is invalid
-            if (distance <= 0) {
-                qDebug() << "Found invalid distance:" << distance << "for" << stadium << "->" << neighbor;
-                removedNeighbors++;
-                continue;
-            }
-            
-            cleanNeighbors[neighbor] = distance;
-        }
-        
-        // Only add stadium if it has valid neighbors
-        if (!cleanNeighbors.isEmpty()) {
-            cleanMatrix[stadium] = cleanNeighbors;
+    // Renumber the remaining stadiums densely and remap the edges
+    QVector<int> remap(stadiumNames.size(), -1);
+    QVector<QString> keptNames;
+    for (int id = 0; id < stadiumNames.size(); ++id) {
+        if (degree[id] > 0) {
+            remap[id] = keptNames.size();
+            keptNames.append(stadiumNames[id]);
         } else {
-            qDebug() << "Removing stadium with no valid neighbors:" << stadium;
-            removedStadiums++;
+            qDebug() << "Removing stadium with no valid neighbors:" << stadiumNames[id];
         }
     }
-
-    // Replace the entire adjacency matrix with the cleaned version
-    adjMatrix = cleanMatrix;
-
-    // Final validation pass
-    qDebug() << "\n=== Final validation pass ===";
-    for (const QString& stadium : adjMatrix.keys()) {
-        qDebug() << "Validating stadium:" << stadium;
-        qDebug() << "  Number of neighbors:" << adjMatrix[stadium].size();
-        for (const QString& neighbor : adjMatrix[stadium].keys()) {
-            if (neighbor.trimmed().isEmpty()) {
-                qCritical() << "FATAL: Found empty neighbor after cleaning! Stadium:" << stadium;
-                adjMatrix[stadium].remove(neighbor);
-                removedNeighbors++;
-            }
-            qDebug() << "  Neighbor:" << neighbor << "Distance:" << adjMatrix[stadium][neighbor];
-        }
+    QHash<quint64, double> keptEdges;
+    keptEdges.reserve(edgeWeights.size());
+    for (auto it = edgeWeights.constBegin(); it != edgeWeights.constEnd(); ++it) {
+        keptEdges.insert(edgeKey(remap[int(it.key() >> 32)], remap[int(it.key() & 0xffffffffu)]), it.value());
     }
 
-    qDebug() << "\n=== Cleaning complete ===";
-    qDebug() << "Removed" << removedStadiums << "empty stadiums";
-    qDebug() << "Removed" << removedNeighbors << "invalid neighbors";
-    qDebug() << "Remaining stadiums:" << adjMatrix.size();
-    
-    // Print all neighbors for target field specifically
-    if (adjMatrix.contains("target field")) {
-        qDebug() << "\nNeighbors for target field after cleaning:";
-        const auto& neighbors = adjMatrix["target field"];
-        for (const QString& neighbor : neighbors.keys()) {
-            qDebug() << "  Neighbor:" << neighbor << "Distance:" << neighbors[neighbor];
-        }
-    }
+    stadiumNames.assign(keptNames);
+    edgeWeights = keptEdges;
+    markModified();
+}
+
+void StadiumGraph::cleanAdjacencyMatrix() {
+    qDebug() << "\n=== Starting adjacency cleaning ===";
+    int before = stadiumNames.size();
+    removeIsolatedStadiums();
+    qDebug() << "Removed" << (before - stadiumNames.size()) << "stadiums with no valid neighbors";
+    qDebug() << "Remaining stadiums:" << stadiumNames.size();
 }
 
 bool StadiumGraph::loadFromCSV(const QString& filename, bool /*clearExisting*/) {
@@ -922,101 +570,28 @@ bool StadiumGraph::loadFromCSV(const QString& filename, bool /*clearExisting*/)
         return false;
     }
 
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    // Rows are parsed and their names normalized in parallel; the merge below
+    // runs in file order so stadium IDs come out the same as a serial load
+    QVector<DistanceRecord> records;
+    int errorCount = 0;
+    if (!DistanceCsv::read(filename, true, records, &errorCount)) {
         qDebug() << "loadFromCSV: Could not open file:" << filename;
         return false;
     }
 
-    try {
-        QTextStream in(&file);
-        // Skip header if it exists
-        if (!in.atEnd()) {
-            QString header = in.readLine();
-            if (!header.contains("Distance") && !header.contains("Mileage")) {
-                file.seek(0);
-                in.seek(0);
-            }
-        }
-
-        int lineCount = 0;
-        int successCount = 0;
-        int errorCount = 0;
-
-        while (!in.atEnd()) {
-            try {
-                lineCount++;
-                QString line = in.readLine().trimmed();
-                if (line.isEmpty()) {
-                    continue;
-                }
-
-                QStringList parts = line.split(',');
-                if (parts.size() < 3) {
-                    qDebug() << "loadFromCSV: Line" << lineCount << "has insufficient parts:" << line;
-                    errorCount++;
-                    continue;
-                }
-
-                QString from = parts[0].trimmed();
-                QString to = parts[1].trimmed();
-                QString distStr = parts[2].trimmed();
-
-                // Strict validation of inputs
-                if (from.isEmpty() || to.isEmpty() || distStr.isEmpty()) {
-                    qDebug() << "loadFromCSV: Line" << lineCount << "has empty fields:" << line;
-                    errorCount++;
-                    continue;
-                }
-
-                bool ok = false;
-                double distance = distStr.toDouble(&ok);
-                if (!ok || distance <= 0) {
-                    qDebug() << "loadFromCSV: Line" << lineCount << "has invalid distance:" << distStr;
-                    errorCount++;
-                    continue;
-                }
-
-                QString nFrom = normalizeStadiumName(from);
-                QString nTo = normalizeStadiumName(to);
-
-                if (nFrom.isEmpty() || nTo.isEmpty()) {
-                    qDebug() << "loadFromCSV: Line" << lineCount << "normalized to empty names:";
-                    qDebug() << "  From:" << from << "->" << nFrom << "(hex):" << nFrom.toUtf8().toHex();
-                    qDebug() << "  To:" << to << "->" << nTo << "(hex):" << nTo.toUtf8().toHex();
-                    errorCount++;
-                    continue;
-                }
-
-                // Additional validation to prevent empty keys
-                if (nFrom.trimmed().isEmpty() || nTo.trimmed().isEmpty()) {
-                    qDebug() << "loadFromCSV: Line" << lineCount << "has empty names after normalization:";
-                    qDebug() << "  From:" << nFrom << "(hex):" << nFrom.toUtf8().toHex();
-                    qDebug() << "  To:" << nTo << "(hex):" << nTo.toUtf8().toHex();
-                    errorCount++;
-                    continue;
-                }
-
-                addEdge(from, to, distance);
-                successCount++;
-
-            } catch (...) {
-                qDebug() << "loadFromCSV: Exception processing line" << lineCount;
-                errorCount++;
-                continue;
-            }
+    edgeWeights.reserve(edgeWeights.size() + records.size());
+    int successCount = 0;
+    for (const DistanceRecord& record : records) {
+        if (addNormalizedEdge(record.from, record.to, record.miles)) {
+            successCount++;
+        } else {
+            errorCount++;
         }
-
-        file.close();
-        qDebug() << "loadFromCSV: Processed" << lineCount << "lines:"
-                 << successCount << "successful," << errorCount << "errors";
-        return successCount > 0;
-
-    } catch (...) {
-        file.close();
-        qDebug() << "loadFromCSV: Exception reading file:" << filename;
-        return false;
     }
+
+    qDebug() << "loadFromCSV: Processed" << successCount + errorCount << "rows:"
+             << successCount << "successful," << errorCount << "errors";
+    return successCount > 0;
 }
 
 bool StadiumGraph::loadMultipleCSVs(const QStringList& filenames) {
@@ -1026,69 +601,56 @@ bool StadiumGraph::loadMultipleCSVs(const QStringList& filenames) {
         qDebug() << "Error: No files provided";
         return false;
     }
-    bool allSuccess = true;
     int successfulFiles = 0;
     for (const QString& filename : filenames) {
         qDebug() << "\nProcessing file:" << filename;
-        try {
-            bool success = loadFromCSV(filename, false); // Always merge, never clear
-            if (success) {
-                successfulFiles++;
-            } else {
-                qDebug() << "Failed to load file:" << filename;
-                allSuccess = false;
-            }
-        } catch (...) {
-            qDebug() << "Exception while loading file:" << filename;
-            allSuccess = false;
-        }
-    }
-    try {
-        qDebug() << "\n=== Loaded Data Summary ===";
-        qDebug() << "Total stadiums:" << getStadiums().size();
-        for (const QString& stadium : getStadiums()) {
-            if (adjMatrix.contains(stadium)) {
-                qDebug() << stadium << "has" << adjMatrix[stadium].size() << "connections";
-                break;  // Just show one stadium as a sample
-            }
+        if (loadFromCSV(filename, false)) { // Always merge, never clear
+            successfulFiles++;
+        } else {
+            qDebug() << "Failed to load file:" << filename;
         }
-        debugPrintAllNeighbors();
-    } catch (const std::exception& e) {
-        qDebug() << "Error printing summary:" << e.what();
-    } catch (...) {
-        qDebug() << "Unknown error printing summary";
     }
+    qDebug() << "\n=== Loaded Data Summary ===";
+    qDebug() << "Total stadiums:" << stadiumNames.size();
+    qDebug() << "Total edges:" << edgeWeights.size();
+    debugPrintAllNeighbors();
     return successfulFiles > 0;  // Return true if at least one file was loaded successfully
 }
 
 void StadiumGraph::clear() {
-    adjMatrix.clear();
+    stadiumNames.clear();
+    edgeWeights.clear();
+    markModified();
 }
 
 bool StadiumGraph::isConnected() const {
-    QVector<QString> stadiums = getStadiums();
-    if (stadiums.isEmpty()) return true;
-    QSet<QString> visited;
-    QQueue<QString> queue;
-    queue.enqueue(stadiums[0]);
-    visited.insert(stadiums[0]);
+    const CsrGraph& g = adjacency();
+    const int n = g.nodeCount();
+    if (n == 0) return true;
+    QVector<bool> visited(n, false);
+    QQueue<int> queue;
+    queue.enqueue(0);
+    visited[0] = true;
+    int reached = 1;
     while (!queue.isEmpty()) {
-        QString current = queue.dequeue();
-        for (const auto& neighbor : adjMatrix[current].keys()) {
-            if (!visited.contains(neighbor)) {
-                visited.insert(neighbor);
-                queue.enqueue(neighbor);
+        int current = queue.dequeue();
+        for (int a = g.rowBegin(current); a < g.rowEnd(current); ++a) {
+            int v = g.target(a);
+            if (!visited[v]) {
+                visited[v] = true;
+                ++reached;
+                queue.enqueue(v);
             }
         }
     }
-    if (visited.size() == stadiums.size()) {
+    if (reached == n) {
         qDebug() << "Graph is fully connected!";
-    return true;
+        return true;
     } else {
         qDebug() << "Graph is NOT fully connected! Unreachable stadiums:";
-        for (const QString& stadium : stadiums) {
-            if (!visited.contains(stadium)) {
-                qDebug() << "-" << stadium;
+        for (int id : idsByName) {
+            if (!visited[id]) {
+                qDebug() << "-" << stadiumNames[id];
             }
         }
         return false;
@@ -1097,26 +659,31 @@ bool StadiumGraph::isConnected() const {
 
 void StadiumGraph::debugPrintUnreachableStadiums() const {
     qDebug() << "\n=== Unreachable Stadiums Check ===";
-    QVector<QString> stadiums = getStadiums();
-    for (const QString& start : stadiums) {
-        QSet<QString> visited;
-        QQueue<QString> queue;
+    const CsrGraph& g = adjacency();
+    const int n = g.nodeCount();
+    QVector<bool> visited(n);
+    QQueue<int> queue;
+    for (int start : idsByName) {
+        visited.fill(false);
         queue.enqueue(start);
-        visited.insert(start);
+        visited[start] = true;
+        int reached = 1;
         while (!queue.isEmpty()) {
-            QString current = queue.dequeue();
-            for (const QString& neighbor : adjMatrix[current].keys()) {
-                if (!visited.contains(neighbor)) {
-                    visited.insert(neighbor);
-                    queue.enqueue(neighbor);
+            int current = queue.dequeue();
+            for (int a = g.rowBegin(current); a < g.rowEnd(current); ++a) {
+                int v = g.target(a);
+                if (!visited[v]) {
+                    visited[v] = true;
+                    ++reached;
+                    queue.enqueue(v);
                 }
             }
         }
-        if (visited.size() != stadiums.size()) {
-            qDebug() << "From" << start << ": unreachable stadiums:";
-            for (const QString& stadium : stadiums) {
-                if (!visited.contains(stadium)) {
-                    qDebug() << "-" << stadium;
+        if (reached != n) {
+            qDebug() << "From" << stadiumNames[start] << ": unreachable stadiums:";
+            for (int id : idsByName) {
+                if (!visited[id]) {
+                    qDebug() << "-" << stadiumNames[id];
                 }
             }
         }
@@ -1126,14 +693,13 @@ void StadiumGraph::debugPrintUnreachableStadiums() const {
 
 void StadiumGraph::debugPrintAllMissingPaths() const {
     qDebug() << "\n=== Missing Paths Between Stadiums (no path exists) ===";
-    QVector<QString> stadiums = getStadiums();
+    std::shared_ptr<const DistanceMatrix> matrix = allPairs();
+    const int n = matrix->nodeCount();
     int missingCount = 0;
-    for (int i = 0; i < stadiums.size(); ++i) {
-        for (int j = i + 1; j < stadiums.size(); ++j) {
-            QVector<QString> path;
-            double dist = dijkstra(stadiums[i], stadiums[j], path);
-            if (dist < 0 || path.isEmpty()) {
-                qDebug() << stadiums[i] << "<->" << stadiums[j] << ": no path";
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            if (!matrix->reachable(i, j)) {
+                qDebug() << stadiumNames[i] << "<->" << stadiumNames[j] << ": no path";
                 ++missingCount;
             }
         }
@@ -1160,92 +726,127 @@ bool StadiumGraph::loadFromDatabase(class Database* db) {
 }
 
 double StadiumGraph::tspNearestNeighbor(const QString& start, QVector<QString>& order) const {
-    QVector<QString> allStadiums = getStadiums();
-    QString nStart = normalizeStadiumName(start);
-    QSet<QString> unvisited(allStadiums.begin(), allStadiums.end());
-    unvisited.remove(nStart);
-
     order.clear();
-    order.append(nStart);
-    QString current = nStart;
+    int current = stadiumId(start);
+    if (current < 0) {
+        return -1.0;
+    }
+    std::shared_ptr<const DistanceMatrix> matrix = allPairs();
+    const int n = matrix->nodeCount();
+    QVector<bool> visitedStop(n, false);
+    visitedStop[current] = true;
+    int remaining = n - 1;
+
+    order.append(stadiumNames[current]);
     double totalDistance = 0.0;
 
-    while (!unvisited.isEmpty()) {
+    while (remaining > 0) {
+        int nearest = -1;
         double minDist = std::numeric_limits<double>::infinity();
-        QString nearest;
-        QVector<QString> bestPath;
-        for (const QString& candidate : unvisited) {
-            QVector<QString> segmentPath;
-            double dist = dijkstra(current, candidate, segmentPath);
-            if (dist >= 0 && dist < minDist) {
-                minDist = dist;
-                nearest = candidate;
-                bestPath = segmentPath;
+        for (int v = 0; v < n; ++v) {
+            if (!visitedStop[v] && matrix->distance(current, v) < minDist) {
+                minDist = matrix->distance(current, v);
+                nearest = v;
             }
         }
-        if (nearest.isEmpty() || minDist == std::numeric_limits<double>::infinity()) {
+        if (nearest < 0) {
             // No path found to remaining stadiums
             return -1.0;
         }
         // Add the path (skip the first stadium to avoid duplicates)
+        QVector<int> bestPath = matrix->path(current, nearest);
         for (int j = 1; j < bestPath.size(); ++j) {
-            order.append(bestPath[j]);
+            order.append(stadiumNames[bestPath[j]]);
         }
         totalDistance += minDist;
         current = nearest;
-        unvisited.remove(current);
+        visitedStop[current] = true;
+        --remaining;
     }
     return totalDistance;
 }
 
+double StadiumGraph::improveTour(QVector<QString>& stops, bool fixStart, int timeBudgetMs) const {
+    QVector<int> ids;
+    for (const QString& stop : stops) {
+        int id = stadiumId(stop);
+        if (id < 0) {
+            qDebug() << "improveTour: stadium not found:" << stop;
+            return -1.0;
+        }
+        if (!ids.contains(id)) {
+            ids.append(id);
+        }
+    }
+
+    // Work on the sub-matrix of the stops themselves
+    std::shared_ptr<const DistanceMatrix> matrix = allPairs();
+    const int k = ids.size();
+    QVector<double> sub(k * k);
+    for (int a = 0; a < k; ++a) {
+        for (int b = 0; b < k; ++b) {
+            sub[a * k + b] = matrix->reachable(ids[a], ids[b]) ? matrix->distance(ids[a], ids[b]) : -1.0;
+        }
+    }
+    QVector<int> order(k);
+    std::iota(order.begin(), order.end(), 0);
+    TourImprover improver(sub, k);
+    double before = improver.pathLength(order);
+    double after = improver.improve(order, fixStart, timeBudgetMs);
+    qDebug() << "improveTour:" << before << "->" << after << "miles over" << k << "stops";
+
+    stops.clear();
+    for (int idx : order) {
+        stops.append(stadiumNames[ids[idx]]);
+    }
+    return after;
+}
+
+double StadiumGraph::optimalTour(const QString& start, QVector<QString>& order, int timeLimitMs, double* gap) const {
+    order.clear();
+    int s = stadiumId(start);
+    if (s < 0) {
+        qDebug() << "optimalTour: start stadium not found:" << start;
+        return -1.0;
+    }
+    std::shared_ptr<const DistanceMatrix> matrix = allPairs();
+    const int n = matrix->nodeCount();
+    QVector<double> dist(n * n);
+    for (int a = 0; a < n; ++a) {
+        for (int b = 0; b < n; ++b) {
+            dist[a * n + b] = matrix->reachable(a, b) ? matrix->distance(a, b) : -1.0;
+        }
+    }
+
+    OptimalTourSolver solver(dist, n);
+    OptimalTourResult result = solver.solve(s, timeLimitMs);
+    if (gap) {
+        *gap = result.gap();
+    }
+    for (int id : result.order) {
+        order.append(stadiumNames[id]);
+    }
+    return result.length;
+}
+
 // DFS traversal that collects discovery edges in order
 void StadiumGraph::dfsRoute(const QString& start, QVector<RouteEdge>& route) const {
-    // Clean adjacency matrix before DFS
-    const_cast<StadiumGraph*>(this)->cleanAdjacencyMatrix();
     route.clear();
-    QString nStart = normalizeStadiumName(start);
-    if (nStart.isEmpty() || !adjMatrix.contains(nStart)) {
-        qWarning() << "DFS ABORT: Start stadium invalid or not in graph:" << nStart;
+    int s = stadiumId(start);
+    if (s < 0) {
+        qWarning() << "DFS ABORT: Start stadium invalid or not in graph:" << start;
         return;
     }
-    if (adjMatrix[nStart].isEmpty()) {
-        qWarning() << "DFS ABORT: Start stadium has no neighbors:" << nStart;
+    if (adjacency().degree(s) == 0) {
+        qWarning() << "DFS ABORT: Start stadium has no neighbors:" << start;
         return;
     }
-    QSet<QString> visited;
-    int maxDepth = 100;
-    std::function<void(const QString&, int)> dfs = [&](const QString& u, int depth) {
-        visited.insert(u);
-        if (adjMatrix[u].contains("")) {
-            qWarning() << "Removing empty neighbor from" << u << "before DFS loop";
-            adjMatrix[u].remove("");
-        }
-        QMap<QString, double> localNeighbors = adjMatrix[u];
-        QVector<QPair<QString, double>> neighbors;
-        for (auto it = localNeighbors.begin(); it != localNeighbors.end(); ++it) {
-            if (it.key().trimmed().isEmpty() || it.value() <= 0) {
-                qWarning() << "Skipping invalid neighbor in DFS:" << it.key() << "Distance:" << it.value();
-                continue;
-            }
-            neighbors.append(qMakePair(it.key(), it.value()));
-        }
-        std::sort(neighbors.begin(), neighbors.end(), [](const QPair<QString, double>& a, const QPair<QString, double>& b) {
-            return a.second < b.second;
-        });
-        if (depth > maxDepth) {
-            qWarning() << "DFS ABORTED: Recursion depth exceeded at node" << u << ", depth:" << depth;
-            return;
-        }
-        for (const auto& neighbor : neighbors) {
-            const QString& v = neighbor.first;
-            double w = neighbor.second;
-            if (!visited.contains(v)) {
-                route.append({u, v, w}); // Discovery edge
-                dfs(v, depth + 1);
-            }
-        }
-    };
-    dfs(nStart, 0);
+    QVector<TraversalStep> steps;
+    depthFirst(s, steps);
+    route.reserve(steps.size() - 1);
+    for (int i = 1; i < steps.size(); ++i) {
+        route.append({stadiumNames[steps[i].from], stadiumNames[steps[i].to], steps[i].miles}); // Discovery edge
+    }
 }
 
 // Function to sum the mileage of the first n-1 discovery edges
@@ -1254,7 +855,7 @@ double StadiumGraph::dfsDiscoveryMileage(const QString& start) const {
     QVector<RouteEdge> route;
     dfsRoute(start, route);
     double total = 0.0;
-    int n = adjMatrix.size();
+    int n = stadiumNames.size();
     for (int i = 0; i < n - 1 && i < route.size(); ++i) {
         total += route[i].miles;
     }
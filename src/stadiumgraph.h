@@ -4,9 +4,16 @@
 #include <QString>
 #include <QVector>
 #include <QMap>
+#include <QHash>
 #include <QPair>
 #include <QSet>
+#include <QMutex>
+#include <atomic>
+#include <memory>
 #include <functional>
+#include "csrgraph.h"
+#include "distancematrix.h"
+#include "stadiumnameindex.h"
 
 // RouteEdge struct for DFS traversal and other algorithms
 struct RouteEdge {
@@ -22,13 +29,17 @@ public:
     void addEdge(const QString& from, const QString& to, double distance);
     double getDistance(const QString& from, const QString& to) const;
     QVector<QString> getStadiums() const;
+    bool hasStadium(const QString& name) const; // accepts any spelling of the name
     QVector<QPair<QString, double>> getNeighbors(const QString& stadium) const;
     void clear();
 
     // Algorithms
     double dijkstra(const QString& start, const QString& end, QVector<QString>& path) const;
+    // Shortest-path distance only (no path), or -1 if unreachable
+    double shortestDistance(const QString& from, const QString& to) const;
     double aStar(const QString& start, const QString& end, QVector<QString>& path) const;
-    double minimumSpanningTree(QVector<QPair<QString, QString>>& mstEdges) const;
+    // Kruskal; on a disconnected graph this is a spanning forest and componentCount says how many trees
+    double minimumSpanningTree(QVector<QPair<QString, QString>>& mstEdges, int* componentCount = nullptr) const;
     double dfs(const QString& start, QVector<QString>& order) const;
     double bfs(const QString& start, QVector<QString>& order) const;
     double greedyTrip(const QString& start, const QVector<QString>& stops, QVector<QString>& order) const;
@@ -40,6 +51,18 @@ public:
     // TSP Nearest Neighbor using Dijkstra between all stadiums
     double tspNearestNeighbor(const QString& start, QVector<QString>& order) const;
 
+    // Shortens a stop order (e.g. from greedyTrip, tspNearestNeighbor or a user
+    // list) with 2-opt/Or-opt over shortest-path distances, so consecutive stops
+    // need not be adjacent. Repeated stops are dropped. Returns the new length,
+    // or -1 if a stop is not in the graph.
+    double improveTour(QVector<QString>& stops, bool fixStart = true, int timeBudgetMs = 200) const;
+
+    // Provably shortest route that starts at start and visits every stadium
+    // (branch and bound). order receives the stops, not the expanded path. If the
+    // time limit cuts the search short, gap receives how far the route may still
+    // be from optimal (0 when proven). Returns the length, or -1.
+    double optimalTour(const QString& start, QVector<QString>& order, int timeLimitMs = 10000, double* gap = nullptr) const;
+
     bool loadFromCSV(const QString& filename, bool clearExisting = false);
     bool loadMultipleCSVs(const QStringList& filenames);
     void debugPrintAllEdges() const;
@@ -63,9 +86,52 @@ public:
 
     void rebuildStadiumConnections(const QString& stadium);
 
+    // Bumped by every structural edit (addEdge, clear, loadFromDatabase, cleaning)
+    quint64 version() const;
+
 private:
-    QMap<QString, QMap<QString, double>> adjMatrix; // adjacency matrix
-    void dfsUtil(const QString& current, QSet<QString>& visited, QVector<QString>& order, double& totalDistance, const QString& prev) const;
+    // Stadiums get dense integer IDs (in insertion order) and every algorithm runs on
+    // those IDs over the CSR arrays; names are only translated at the API boundary.
+    StadiumNameIndex stadiumNames;      // ID <-> normalized name, looked up by raw spelling
+    QHash<quint64, double> edgeWeights; // (lower ID, higher ID) -> miles, edited by addEdge
+
+    // CSR view of edgeWeights, rebuilt on first use after a mutation.
+    // Mutations must not run concurrently with queries.
+    mutable CsrGraph csr;
+    mutable QVector<int> idsByName;     // IDs in name order, for getStadiums()
+    mutable QVector<int> arcsByWeight;  // per CSR row, arc indices closest first (ties by name)
+    mutable int connectedStadiums = 0;  // stadiums with at least one edge
+    mutable std::atomic<bool> csrDirty{false};
+    mutable QMutex csrMutex;
+    std::atomic<quint64> graphVersion{0};
+
+    // All-pairs distances and next hops, rebuilt lazily when graphVersion moves on
+    mutable std::shared_ptr<const DistanceMatrix> pairs;
+    mutable quint64 pairsVersion = 0;
+    mutable QMutex pairsMutex;
+
+    // Edges sorted by weight for Kruskal, cached per graph version (guarded by pairsMutex)
+    mutable std::shared_ptr<const QVector<CsrEdge>> sortedEdges;
+    mutable quint64 sortedEdgesVersion = 0;
+
+    static quint64 edgeKey(int a, int b);
+    int stadiumId(QStringView name) const; // any spelling; -1 if not in the graph
+    int internStadium(const QString& normalized);
+    bool addNormalizedEdge(const QString& nFrom, const QString& nTo, double distance); // false for a self-loop
+    void markModified();
+    const CsrGraph& adjacency() const;
+    std::shared_ptr<const DistanceMatrix> allPairs() const;
+    std::shared_ptr<const QVector<CsrEdge>> edgesByWeight() const;
+    void removeIsolatedStadiums();
+
+    struct TraversalStep {
+        int from;     // -1 for the start
+        int to;
+        double miles;
+    };
+    void depthFirst(int start, QVector<TraversalStep>& steps) const;
+    void breadthFirst(int start, QVector<TraversalStep>& steps) const;
+    int connectedStadiumCount() const;
 };
 
-#endif // STADIUMGRAPH_H 
\ No newline at end of file
+#endif // STADIUMGRAPH_H
@@ -4,19 +4,63 @@
 #include <QString>
 #include <QVector>
 #include <QPair>
+#include "souvenircatalog.h"
+#include "attributedictionary.h"
 
+// Low-cardinality fields are codes into the shared AttributeDictionary
+// instances and the opening date is a year, so comparing or filtering them
+// reads a few bytes of the record; the text is only built for display.
 struct StadiumInfo {
     QString teamName;
     QString stadiumName;
-    int seatingCapacity;
     QString location;
-    QString playingSurface;
-    QString league;
-    QString dateOpened;
-    int distanceToCenter;
-    QString ballparkTypology;
-    QString roofType;
-    QVector<QPair<QString, double>> souvenirs;  // List of souvenirs and their prices
+    int seatingCapacity = 0;
+    int distanceToCenter = 0;
+    int yearOpened = 0;                  // 0 if unknown
+    AttributeCode league = 0;            // AttributeDictionary::leagues()
+    AttributeCode playingSurface = 0;    // AttributeDictionary::surfaces()
+    AttributeCode ballparkTypology = 0;  // AttributeDictionary::typologies()
+    AttributeCode roofType = 0;          // AttributeDictionary::roofs()
+    SouvenirList souvenirs;  // shared catalog plus this team's own prices and items
+
+    QString leagueName() const { return AttributeDictionary::leagues().decode(league); }
+    QString surfaceName() const { return AttributeDictionary::surfaces().decode(playingSurface); }
+    QString typologyName() const { return AttributeDictionary::typologies().decode(ballparkTypology); }
+    QString roofName() const { return AttributeDictionary::roofs().decode(roofType); }
+    QString dateOpened() const { return yearText(yearOpened); }
+
+    // Encodes the text fields as stored in the teams table
+    void setAttributes(const QString &leagueText, const QString &surfaceText,
+                       const QString &typologyText, const QString &roofText,
+                       const QString &dateOpenedText) {
+        league = AttributeDictionary::leagues().encode(leagueText);
+        playingSurface = AttributeDictionary::surfaces().encode(surfaceText);
+        ballparkTypology = AttributeDictionary::typologies().encode(typologyText);
+        roofType = AttributeDictionary::roofs().encode(roofText);
+        yearOpened = parseYear(dateOpenedText);
+    }
+
+    // First standalone four-digit number in the text, as TeamCsv keeps it; 0 if none
+    static int parseYear(const QString &text) {
+        for (int i = 0; i < text.size(); ) {
+            if (!text[i].isDigit()) {
+                ++i;
+                continue;
+            }
+            int end = i;
+            while (end < text.size() && text[end].isDigit()) {
+                ++end;
+            }
+            const bool bounded = (i == 0 || !text[i - 1].isLetter())
+                                 && (end == text.size() || !text[end].isLetter());
+            if (end - i == 4 && bounded) {
+                return text.mid(i, 4).toInt();
+            }
+            i = end;
+        }
+        return 0;
+    }
+    static QString yearText(int year) { return year > 0 ? QString::number(year) : QString(); }
 };
 
-#endif // STADIUMINFO_H 
\ No newline at end of file
+#endif // STADIUMINFO_H
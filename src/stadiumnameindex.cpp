@@ -0,0 +1,162 @@
+#include "stadiumnameindex.h"
+#include <array>
+
+namespace {
+
+enum CharClass : unsigned char { Drop, Keep, Upper, Space, Dash };
+
+constexpr std::array<unsigned char, 128> makeCharClasses() {
+    std::array<unsigned char, 128> table{};
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = Keep;
+    for (int c = '0'; c <= '9'; ++c) table[c] = Keep;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = Upper;
+    table[' '] = table['\t'] = table['\n'] = table['\v'] = table['\f'] = table['\r'] = Space;
+    table['-'] = Dash;
+    return table;
+}
+
+constexpr std::array<unsigned char, 128> CharClasses = makeCharClasses();
+
+// Passes the normalized form of raw to sink, one UTF-16 unit at a time
+template <typename Sink>
+inline void forEachNormalized(QStringView raw, Sink sink) {
+    bool pendingSpace = false;
+    bool started = false;
+    for (QChar ch : raw) {
+        const char16_t u = ch.unicode();
+        char16_t out;
+        if (u < 128) {
+            switch (CharClasses[u]) {
+            case Drop:
+                continue;
+            case Space:
+                pendingSpace = started;
+                continue;
+            case Upper:
+                out = char16_t(u + ('a' - 'A'));
+                break;
+            case Dash:
+                out = u'-';
+                break;
+            default:
+                out = u;
+                break;
+            }
+        } else if (u >= 0x2012 && u <= 0x2015) {
+            out = u'-'; // figure dash, en dash, em dash, horizontal bar
+        } else {
+            continue;
+        }
+        if (pendingSpace) {
+            sink(u' ');
+            pendingSpace = false;
+        }
+        sink(out);
+        started = true;
+    }
+}
+
+// FNV-1a over the normalized UTF-16 units
+inline quint32 normalizedHash(QStringView raw) {
+    quint32 h = 2166136261u;
+    forEachNormalized(raw, [&h](char16_t c) {
+        h = (h ^ c) * 16777619u;
+    });
+    return h;
+}
+
+inline bool normalizedEquals(QStringView raw, const QString& normalized) {
+    const QChar* expected = normalized.constData();
+    const int length = normalized.size();
+    int i = 0;
+    bool equal = true;
+    forEachNormalized(raw, [&](char16_t c) {
+        if (equal && (i >= length || expected[i].unicode() != c)) {
+            equal = false;
+        }
+        ++i;
+    });
+    return equal && i == length;
+}
+
+} // namespace
+
+QString StadiumNameIndex::normalize(QStringView raw) {
+    QString result;
+    result.reserve(raw.size());
+    forEachNormalized(raw, [&result](char16_t c) {
+        result.append(QChar(c));
+    });
+    return result;
+}
+
+int StadiumNameIndex::find(QStringView raw) const {
+    if (buckets.isEmpty()) {
+        return -1;
+    }
+    const quint32 h = normalizedHash(raw);
+    const int mask = buckets.size() - 1;
+    for (int s = int(h) & mask;; s = (s + 1) & mask) {
+        int id = buckets[s];
+        if (id < 0) {
+            return -1;
+        }
+        if (hashes[id] == h && normalizedEquals(raw, names[id])) {
+            return id;
+        }
+    }
+}
+
+int StadiumNameIndex::intern(QStringView raw) {
+    int id = find(raw);
+    if (id >= 0) {
+        return id;
+    }
+    QString normalized = normalize(raw);
+    if (normalized.isEmpty()) {
+        return -1;
+    }
+    add(normalized);
+    return names.size() - 1;
+}
+
+void StadiumNameIndex::assign(const QVector<QString>& normalizedNames) {
+    clear();
+    for (const QString& name : normalizedNames) {
+        add(name);
+    }
+}
+
+void StadiumNameIndex::clear() {
+    names.clear();
+    hashes.clear();
+    buckets.clear();
+}
+
+void StadiumNameIndex::add(const QString& normalized) {
+    names.append(normalized);
+    hashes.append(normalizedHash(normalized));
+    // Keep the table at most half full so probe sequences stay short
+    if (buckets.size() < names.size() * 2) {
+        rehash(qMax(16, int(buckets.size()) * 2));
+    } else {
+        const int mask = buckets.size() - 1;
+        int s = int(hashes.last()) & mask;
+        while (buckets[s] >= 0) {
+            s = (s + 1) & mask;
+        }
+        buckets[s] = names.size() - 1;
+    }
+}
+
+void StadiumNameIndex::rehash(int bucketCount) {
+    buckets = QVector<int>(bucketCount, -1);
+    const int mask = bucketCount - 1;
+    for (int id = 0; id < names.size(); ++id) {
+        int s = int(hashes[id]) & mask;
+        while (buckets[s] >= 0) {
+            s = (s + 1) & mask;
+        }
+        buckets[s] = id;
+    }
+}
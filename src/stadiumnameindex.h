@@ -0,0 +1,40 @@
+#ifndef STADIUMNAMEINDEX_H
+#define STADIUMNAMEINDEX_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+// Interns normalized stadium names and hands out dense IDs (0, 1, 2, ...).
+// Raw spellings ("Oakland–Alameda  County Coliseum", "ORACLE PARK") are
+// normalized on the fly while hashing and comparing, so find() is a single
+// open-addressing probe sequence that never builds a temporary string.
+class StadiumNameIndex {
+public:
+    // Trim, lowercase, map Unicode dashes to '-', drop anything other than
+    // [a-z0-9 -] and collapse runs of whitespace; empty if nothing is left
+    static QString normalize(QStringView raw);
+
+    int find(QStringView raw) const;    // -1 if unknown
+    int intern(QStringView raw);        // existing or new ID; -1 if it normalizes to empty
+
+    // Replaces the contents; each (already normalized) name gets its position as ID
+    void assign(const QVector<QString>& normalizedNames);
+    void clear();
+
+    int size() const { return names.size(); }
+    bool isEmpty() const { return names.isEmpty(); }
+    const QString& operator[](int id) const { return names[id]; }
+    QVector<QString>::const_iterator begin() const { return names.constBegin(); }
+    QVector<QString>::const_iterator end() const { return names.constEnd(); }
+
+private:
+    void add(const QString& normalized);
+    void rehash(int bucketCount);
+
+    QVector<QString> names;   // ID -> normalized name
+    QVector<quint32> hashes;  // ID -> hash of the normalized name
+    QVector<int> buckets;       // open addressing over IDs, -1 = empty; size is a power of two
+};
+
+#endif // STADIUMNAMEINDEX_H
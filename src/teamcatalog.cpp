@@ -0,0 +1,528 @@
+#include "teamcatalog.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+
+namespace {
+
+// -1, 0 or 1, so the view comparators can chain keys
+template<typename T>
+int compareKeys(const T &a, const T &b)
+{
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+} // namespace
+
+void TeamCatalog::reset(const QVector<StadiumInfo> &teams)
+{
+    QWriteLocker locker(&lock);
+    teamName.clear();
+    stadiumName.clear();
+    capacity.clear();
+    location.clear();
+    surface.clear();
+    league.clear();
+    yearOpened.clear();
+    centerField.clear();
+    typology.clear();
+    roof.clear();
+    rowByName.clear();
+    named = RowBitmap();
+    for (auto &index : valueRows) {
+        index.clear();
+    }
+    capacityBuckets.clear();
+    centerFieldBuckets.clear();
+
+    for (const StadiumInfo &team : teams) {
+        const QString name = team.teamName.trimmed();
+        int row = rowByName.value(name, -1);
+        if (row < 0) {
+            row = teamName.size();
+            rowByName.insert(name, row);
+            teamName.resize(row + 1);
+            stadiumName.resize(row + 1);
+            capacity.resize(row + 1);
+            location.resize(row + 1);
+            surface.resize(row + 1);
+            league.resize(row + 1);
+            yearOpened.resize(row + 1);
+            centerField.resize(row + 1);
+            typology.resize(row + 1);
+            roof.resize(row + 1);
+        }
+        setRow(row, team);
+    }
+
+    // One sort per view; later changes are placed by binary search
+    for (int v = 0; v < ViewCount; ++v) {
+        const ViewId view = ViewId(v);
+        QVector<int> &order = views[v].order;
+        order.clear();
+        for (int row = 0; row < teamName.size(); ++row) {
+            if (includes(view, row)) {
+                order.append(row);
+            }
+        }
+        std::sort(order.begin(), order.end(), [this, view](int a, int b) { return less(view, a, b); });
+    }
+    for (int row = 0; row < teamName.size(); ++row) {
+        indexRow(row);
+    }
+    loaded = true;
+}
+
+bool TeamCatalog::isLoaded() const
+{
+    QReadLocker locker(&lock);
+    return loaded;
+}
+
+void TeamCatalog::upsert(const StadiumInfo &team)
+{
+    QWriteLocker locker(&lock);
+    const QString name = team.teamName.trimmed();
+    int row = rowByName.value(name, -1);
+    if (row >= 0) {
+        // Out of every view and bitmap under the old keys, back in under the new ones
+        removeFromViews(row);
+        unindexRow(row);
+    } else {
+        row = teamName.size();
+        rowByName.insert(name, row);
+        teamName.append(QString());
+        stadiumName.append(QString());
+        capacity.append(0);
+        location.append(QString());
+        surface.append(0);
+        league.append(0);
+        yearOpened.append(0);
+        centerField.append(0);
+        typology.append(0);
+        roof.append(0);
+    }
+    setRow(row, team);
+    insertIntoViews(row);
+    indexRow(row);
+}
+
+void TeamCatalog::upsert(const TeamRecord &team)
+{
+    StadiumInfo info;
+    info.teamName = team.teamName;
+    info.stadiumName = team.stadiumName;
+    info.seatingCapacity = team.capacity;
+    info.location = team.location;
+    info.distanceToCenter = team.centerField;
+    info.setAttributes(team.league, team.surface, team.typology, team.roof, team.dateOpened);
+    upsert(info);
+}
+
+void TeamCatalog::setRow(int row, const StadiumInfo &team)
+{
+    teamName[row] = team.teamName.trimmed();
+    stadiumName[row] = team.stadiumName.trimmed();
+    capacity[row] = team.seatingCapacity;
+    location[row] = team.location.trimmed();
+    surface[row] = team.playingSurface;
+    league[row] = team.league;
+    yearOpened[row] = team.yearOpened;
+    centerField[row] = team.distanceToCenter;
+    typology[row] = team.ballparkTypology;
+    roof[row] = team.roofType;
+    // Cheap while the dictionary is unchanged (the copy is shared); a newer
+    // snapshot keeps the old codes in the same relative order
+    typologyRanks = AttributeDictionary::typologies().ranks();
+}
+
+bool TeamCatalog::includes(ViewId view, int row) const
+{
+    // Mirrors the WHERE clauses of the SQL listings
+    switch (view) {
+    case ByTeamName:    return !teamName[row].isEmpty();
+    case ByStadiumName: return !stadiumName[row].isEmpty();
+    case ByTypology:    return typology[row] != 0;
+    case ByDateOpened:  return yearOpened[row] > 0;
+    case ByCapacity:    return true;
+    case ByCenterField: return centerField[row] > 0;
+    case ViewCount:     break;
+    }
+    return false;
+}
+
+bool TeamCatalog::less(ViewId view, int a, int b) const
+{
+    int order = 0;
+    switch (view) {
+    case ByTeamName:    break;
+    case ByStadiumName: order = compareKeys(stadiumName[a], stadiumName[b]); break;
+    case ByTypology:    order = compareKeys(typologyRanks[typology[a]], typologyRanks[typology[b]]); break;
+    case ByDateOpened:  order = compareKeys(yearOpened[a], yearOpened[b]); break;
+    case ByCapacity:    order = compareKeys(capacity[a], capacity[b]); break;
+    case ByCenterField: order = compareKeys(centerField[a], centerField[b]); break;
+    case ViewCount:     break;
+    }
+    if (order == 0) {
+        order = compareKeys(teamName[a], teamName[b]);
+    }
+    // The row id makes the order total, so a row's slot is found exactly
+    return order != 0 ? order < 0 : a < b;
+}
+
+void TeamCatalog::insertIntoViews(int row)
+{
+    for (int v = 0; v < ViewCount; ++v) {
+        const ViewId view = ViewId(v);
+        if (!includes(view, row)) {
+            continue;
+        }
+        QVector<int> &order = views[v].order;
+        auto it = std::lower_bound(order.begin(), order.end(), row,
+                                   [this, view](int a, int b) { return less(view, a, b); });
+        order.insert(it, row);
+    }
+}
+
+void TeamCatalog::removeFromViews(int row)
+{
+    // Called before the columns change, so the old keys locate the row
+    for (int v = 0; v < ViewCount; ++v) {
+        const ViewId view = ViewId(v);
+        if (!includes(view, row)) {
+            continue;
+        }
+        QVector<int> &order = views[v].order;
+        auto it = std::lower_bound(order.begin(), order.end(), row,
+                                   [this, view](int a, int b) { return less(view, a, b); });
+        if (it != order.end() && *it == row) {
+            order.erase(it);
+        }
+    }
+}
+
+AttributeCode TeamCatalog::column(Attribute attribute, int row) const
+{
+    switch (attribute) {
+    case League:         return league[row];
+    case Roof:           return roof[row];
+    case Surface:        return surface[row];
+    case Typology:       break;
+    case AttributeCount: break;
+    }
+    return typology[row];
+}
+
+AttributeDictionary &TeamCatalog::dictionary(Attribute attribute)
+{
+    switch (attribute) {
+    case League:         return AttributeDictionary::leagues();
+    case Roof:           return AttributeDictionary::roofs();
+    case Surface:        return AttributeDictionary::surfaces();
+    case Typology:       break;
+    case AttributeCount: break;
+    }
+    return AttributeDictionary::typologies();
+}
+
+void TeamCatalog::indexRow(int row)
+{
+    if (!teamName[row].isEmpty()) {
+        named.set(row);
+    }
+    for (int a = 0; a < AttributeCount; ++a) {
+        const AttributeCode code = column(Attribute(a), row);
+        if (code == 0) {
+            continue;
+        }
+        const QString value = dictionary(Attribute(a)).decode(code);
+        ValueRows &index = valueRows[a][value.toUpper()];
+        if (index.label.isEmpty()) {
+            index.label = value;
+        }
+        index.rows.set(row);
+    }
+    const int capacityBucket = qMax(0, capacity[row]) / CapacityBucket;
+    if (capacityBucket >= capacityBuckets.size()) {
+        capacityBuckets.resize(capacityBucket + 1);
+    }
+    capacityBuckets[capacityBucket].set(row);
+    if (centerField[row] > 0) {
+        const int centerFieldBucket = centerField[row] / CenterFieldBucket;
+        if (centerFieldBucket >= centerFieldBuckets.size()) {
+            centerFieldBuckets.resize(centerFieldBucket + 1);
+        }
+        centerFieldBuckets[centerFieldBucket].set(row);
+    }
+}
+
+void TeamCatalog::unindexRow(int row)
+{
+    named.clear(row);
+    for (int a = 0; a < AttributeCount; ++a) {
+        const AttributeCode code = column(Attribute(a), row);
+        if (code == 0) {
+            continue;
+        }
+        auto it = valueRows[a].find(dictionary(Attribute(a)).decode(code).toUpper());
+        if (it == valueRows[a].end()) {
+            continue;
+        }
+        it.value().rows.clear(row);
+        if (it.value().rows.isEmpty()) {
+            valueRows[a].erase(it);  // no longer offered by values()
+        }
+    }
+    const int capacityBucket = qMax(0, capacity[row]) / CapacityBucket;
+    if (capacityBucket < capacityBuckets.size()) {
+        capacityBuckets[capacityBucket].clear(row);
+    }
+    const int centerFieldBucket = centerField[row] / CenterFieldBucket;
+    if (centerField[row] > 0 && centerFieldBucket < centerFieldBuckets.size()) {
+        centerFieldBuckets[centerFieldBucket].clear(row);
+    }
+}
+
+RowBitmap TeamCatalog::matchAny(Attribute attribute, const QStringList &wanted) const
+{
+    RowBitmap rows;
+    for (const QString &value : wanted) {
+        auto it = valueRows[attribute].constFind(value.trimmed().toUpper());
+        if (it != valueRows[attribute].constEnd()) {
+            rows |= it.value().rows;
+        }
+    }
+    return rows;
+}
+
+RowBitmap TeamCatalog::matchRange(const QVector<RowBitmap> &buckets, int bucketWidth,
+                                  const QVector<int> &column, int min, int max)
+{
+    RowBitmap rows;
+    const int first = qMax(0, min) / bucketWidth;
+    const int last = max > 0 ? qMin(max / bucketWidth, int(buckets.size()) - 1) : int(buckets.size()) - 1;
+    if (first > last) {
+        return rows;
+    }
+    for (int bucket = first; bucket <= last; ++bucket) {
+        rows |= buckets[bucket];
+    }
+    // Only the end buckets can hold values outside [min, max]
+    auto trim = [&](int bucket) {
+        buckets[bucket].forEach([&](int row) {
+            if (column[row] < min || (max > 0 && column[row] > max)) {
+                rows.clear(row);
+            }
+        });
+    };
+    trim(first);
+    if (last != first) {
+        trim(last);
+    }
+    return rows;
+}
+
+QString TeamCatalog::withThousands(int value)
+{
+    QString digits = QString::number(qAbs(qint64(value)));
+    for (int i = digits.size() - 3; i > 0; i -= 3) {
+        digits.insert(i, QLatin1Char(','));
+    }
+    return value < 0 ? QLatin1Char('-') + digits : digits;
+}
+
+QString TeamCatalog::feetAndMeters(int feet)
+{
+    return QString("%1 feet (%2 m)").arg(feet).arg(qRound(feet * 0.3048));
+}
+
+QueryResult TeamCatalog::teamInfo(const QString &name) const
+{
+    QReadLocker locker(&lock);
+    QueryResult result;
+    const int row = rowByName.value(name.trimmed(), -1);
+    if (row < 0) {
+        return result;
+    }
+    result.rows.append({teamName[row], stadiumName[row], withThousands(capacity[row]),
+                        location[row], dictionary(Surface).decode(surface[row]),
+                        dictionary(League).decode(league[row]), StadiumInfo::yearText(yearOpened[row]),
+                        centerField[row] > 0 ? feetAndMeters(centerField[row]) : QString("0"),
+                        dictionary(Typology).decode(typology[row]), dictionary(Roof).decode(roof[row])});
+    return result;
+}
+
+QueryResult TeamCatalog::teamsByTeamName() const
+{
+    QReadLocker locker(&lock);
+    QueryResult result;
+    result.rows.reserve(views[ByTeamName].order.size());
+    for (int row : views[ByTeamName].order) {
+        result.rows.append({teamName[row], stadiumName[row]});
+    }
+    return result;
+}
+
+QueryResult TeamCatalog::teamsByStadiumName() const
+{
+    QReadLocker locker(&lock);
+    QueryResult result;
+    result.rows.reserve(views[ByStadiumName].order.size());
+    for (int row : views[ByStadiumName].order) {
+        result.rows.append({teamName[row], stadiumName[row]});
+    }
+    return result;
+}
+
+QueryResult TeamCatalog::teamsInLeague(const QString &leagueKey) const
+{
+    QReadLocker locker(&lock);
+    QueryResult result;
+    const RowBitmap inLeague = valueRows[League].value(leagueKey.toUpper()).rows;
+    for (int row : views[ByTeamName].order) {
+        if (inLeague.test(row)) {
+            result.rows.append({teamName[row], stadiumName[row]});
+        }
+    }
+    return result;
+}
+
+QueryResult TeamCatalog::teamsByTypology() const
+{
+    QReadLocker locker(&lock);
+    QueryResult result;
+    result.rows.reserve(views[ByTypology].order.size());
+    for (int row : views[ByTypology].order) {
+        result.rows.append({stadiumName[row], teamName[row], dictionary(Typology).decode(typology[row])});
+    }
+    return result;
+}
+
+QueryResult TeamCatalog::openRoofTeams() const
+{
+    QReadLocker locker(&lock);
+    QueryResult result;
+    const RowBitmap open = valueRows[Roof].value(QString("OPEN")).rows;
+    for (int row : views[ByTeamName].order) {
+        if (open.test(row)) {
+            result.rows.append({teamName[row]});
+        }
+    }
+    return result;
+}
+
+QueryResult TeamCatalog::teamsByDateOpened() const
+{
+    QReadLocker locker(&lock);
+    QueryResult result;
+    result.rows.reserve(views[ByDateOpened].order.size());
+    for (int row : views[ByDateOpened].order) {
+        result.rows.append({stadiumName[row], teamName[row], StadiumInfo::yearText(yearOpened[row])});
+    }
+    return result;
+}
+
+QueryResult TeamCatalog::teamsByCapacity() const
+{
+    QReadLocker locker(&lock);
+    QueryResult result;
+    result.rows.reserve(views[ByCapacity].order.size());
+    for (int row : views[ByCapacity].order) {
+        result.rows.append({stadiumName[row], teamName[row], capacity[row]});
+    }
+    return result;
+}
+
+QueryResult TeamCatalog::greatestCenterField() const
+{
+    return centerFieldBlock(true);
+}
+
+QueryResult TeamCatalog::smallestCenterField() const
+{
+    return centerFieldBlock(false);
+}
+
+QueryResult TeamCatalog::centerFieldBlock(bool greatest) const
+{
+    // The extreme distance is at one end of the view; its ties are the
+    // adjacent rows, already in team name order
+    QReadLocker locker(&lock);
+    QueryResult result;
+    const QVector<int> &order = views[ByCenterField].order;
+    if (order.isEmpty()) {
+        return result;
+    }
+    const int distance = centerField[greatest ? order.last() : order.first()];
+    int first = 0;
+    int last = order.size();
+    if (greatest) {
+        first = last - 1;
+        while (first > 0 && centerField[order[first - 1]] == distance) {
+            --first;
+        }
+    } else {
+        last = 1;
+        while (last < order.size() && centerField[order[last]] == distance) {
+            ++last;
+        }
+    }
+    for (int i = first; i < last; ++i) {
+        const int row = order[i];
+        result.rows.append({stadiumName[row], teamName[row], feetAndMeters(distance)});
+    }
+    return result;
+}
+
+QueryResult TeamCatalog::filter(const TeamFilter &conditions) const
+{
+    QReadLocker locker(&lock);
+    RowBitmap rows = named;
+    if (!conditions.leagues.isEmpty()) {
+        rows &= matchAny(League, conditions.leagues);
+    }
+    if (!conditions.roofs.isEmpty()) {
+        rows &= matchAny(Roof, conditions.roofs);
+    }
+    if (!conditions.surfaces.isEmpty()) {
+        rows &= matchAny(Surface, conditions.surfaces);
+    }
+    if (!conditions.typologies.isEmpty()) {
+        rows &= matchAny(Typology, conditions.typologies);
+    }
+    if (conditions.minCapacity > 0 || conditions.maxCapacity > 0) {
+        rows &= matchRange(capacityBuckets, CapacityBucket, capacity,
+                           conditions.minCapacity, conditions.maxCapacity);
+    }
+    if (conditions.minCenterField > 0 || conditions.maxCenterField > 0) {
+        rows &= matchRange(centerFieldBuckets, CenterFieldBucket, centerField,
+                           conditions.minCenterField, conditions.maxCenterField);
+    }
+
+    // Matches are usually few; sorting them beats walking the name view
+    QVector<int> matches;
+    matches.reserve(rows.count());
+    rows.forEach([&matches](int row) { matches.append(row); });
+    std::sort(matches.begin(), matches.end(), [this](int a, int b) { return less(ByTeamName, a, b); });
+
+    QueryResult result;
+    result.rows.reserve(matches.size());
+    for (int row : matches) {
+        result.rows.append({teamName[row], stadiumName[row], dictionary(League).decode(league[row]),
+                            dictionary(Roof).decode(roof[row]), dictionary(Surface).decode(surface[row]),
+                            dictionary(Typology).decode(typology[row]), withThousands(capacity[row]),
+                            centerField[row] > 0 ? feetAndMeters(centerField[row]) : QString("0")});
+    }
+    return result;
+}
+
+QStringList TeamCatalog::values(Attribute attribute) const
+{
+    QReadLocker locker(&lock);
+    QStringList labels;
+    for (const ValueRows &index : valueRows[attribute]) {
+        labels.append(index.label);
+    }
+    labels.sort(Qt::CaseInsensitive);
+    return labels;
+}
@@ -0,0 +1,145 @@
+#ifndef TEAMCATALOG_H
+#define TEAMCATALOG_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "stadiuminfo.h"
+#include "teamcsv.h"
+#include "querycache.h"
+#include "rowbitmap.h"
+
+// Conditions for TeamCatalog::filter(). Values within one list are alternatives
+// (matched case-insensitively); the lists and ranges must all hold. Empty lists
+// and zero bounds don't filter.
+struct TeamFilter {
+    QStringList leagues;
+    QStringList roofs;
+    QStringList surfaces;
+    QStringList typologies;
+    int minCapacity = 0;
+    int maxCapacity = 0;
+    int minCenterField = 0;     // any center-field bound drops unknown (0) rows
+    int maxCenterField = 0;
+};
+
+// Column store of the teams table for the catalog listings. Each StadiumInfo
+// field is its own array indexed by a dense row id, and every listing order
+// is a permutation of row ids kept sorted as rows change: an upsert takes the
+// row out of each view at its old key and binary-searches it back in, so the
+// listings are produced without sorting and the center-field extremes sit at
+// the ends of their view.
+//
+// The low-cardinality columns (league, roof, surface, typology) also keep a
+// bitmap of rows per distinct value, and capacity / center field a bitmap per
+// fixed-width range bucket, so filter() combines conditions with word-wide
+// AND/OR instead of scanning rows.
+//
+// The coded StadiumInfo fields are stored as their codes, so the typology and
+// date views compare integers; text is decoded only for the rows returned.
+//
+// Shared by every Database connection to the file; reads and writes lock.
+// Text is trimmed on the way in, matching what the database stores.
+class TeamCatalog {
+public:
+    enum ViewId {
+        ByTeamName,
+        ByStadiumName,
+        ByTypology,      // typology, then team name
+        ByDateOpened,
+        ByCapacity,
+        ByCenterField,   // rows with a known (> 0) center field only
+        ViewCount
+    };
+
+    enum Attribute {
+        League,
+        Roof,
+        Surface,
+        Typology,
+        AttributeCount
+    };
+
+    // Replaces the whole catalog; the views are sorted once
+    void reset(const QVector<StadiumInfo> &teams);
+    bool isLoaded() const;  // false until the first reset()
+
+    // Adds the team, or updates it in place if the name is already present
+    void upsert(const StadiumInfo &team);
+    void upsert(const TeamRecord &team);
+
+    // Same columns and order as the matching Database queries
+    QueryResult teamInfo(const QString &name) const;
+    QueryResult teamsByTeamName() const;
+    QueryResult teamsByStadiumName() const;
+    QueryResult teamsInLeague(const QString &leagueKey) const;  // "AMERICAN" / "NATIONAL"
+    QueryResult teamsByTypology() const;
+    QueryResult openRoofTeams() const;
+    QueryResult teamsByDateOpened() const;
+    QueryResult teamsByCapacity() const;
+    QueryResult greatestCenterField() const;
+    QueryResult smallestCenterField() const;
+
+    // Teams matching every condition, by team name: team, stadium, league,
+    // roof, surface, typology, capacity, center field
+    QueryResult filter(const TeamFilter &conditions) const;
+    // Values of the attribute currently in use, as spelled in the data, sorted
+    QStringList values(Attribute attribute) const;
+
+private:
+    struct View {
+        QVector<int> order;  // row ids, sorted by less(), ties broken by row id
+    };
+    struct ValueRows {
+        QString label;       // first spelling seen
+        RowBitmap rows;
+    };
+
+    static const int CapacityBucket = 5000;    // seats per bucket
+    static const int CenterFieldBucket = 10;   // feet per bucket
+
+    bool less(ViewId view, int a, int b) const;
+    bool includes(ViewId view, int row) const;
+    void insertIntoViews(int row);
+    void removeFromViews(int row);
+    void indexRow(int row);
+    void unindexRow(int row);
+    AttributeCode column(Attribute attribute, int row) const;
+    static AttributeDictionary &dictionary(Attribute attribute);
+    RowBitmap matchAny(Attribute attribute, const QStringList &wanted) const;
+    static RowBitmap matchRange(const QVector<RowBitmap> &buckets, int bucketWidth,
+                                const QVector<int> &column, int min, int max);
+    void setRow(int row, const StadiumInfo &team);
+    QueryResult centerFieldBlock(bool greatest) const;
+
+    static QString withThousands(int value);       // printf('%,d')
+    static QString feetAndMeters(int feet);        // "400 feet (122 m)"
+
+    mutable QReadWriteLock lock;
+    bool loaded = false;
+
+    // One array per StadiumInfo field
+    QVector<QString> teamName;
+    QVector<QString> stadiumName;
+    QVector<int> capacity;
+    QVector<QString> location;
+    QVector<AttributeCode> surface;
+    QVector<AttributeCode> league;
+    QVector<int> yearOpened;
+    QVector<int> centerField;
+    QVector<AttributeCode> typology;
+    QVector<AttributeCode> roof;
+    QVector<int> typologyRanks;  // AttributeDictionary::ranks() as of the last setRow()
+
+    QHash<QString, int> rowByName;
+    View views[ViewCount];
+
+    RowBitmap named;                                   // rows with a team name
+    QHash<QString, ValueRows> valueRows[AttributeCount];  // keyed by upper-case value
+    QVector<RowBitmap> capacityBuckets;
+    QVector<RowBitmap> centerFieldBuckets;            // known (> 0) distances only
+};
+
+#endif // TEAMCATALOG_H
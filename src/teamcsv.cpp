@@ -0,0 +1,75 @@
+#include "teamcsv.h"
+#include <QRegularExpression>
+
+bool TeamCsv::parseRow(const QStringList& fields, TeamRecord& record) {
+    if (fields.size() < ColumnCount) {
+        return false;
+    }
+    record.teamName = fields[0].trimmed();
+    if (record.teamName.isEmpty()) {
+        return false;
+    }
+    record.stadiumName = fields[1].trimmed();
+
+    // Clean up capacity data (digits only, e.g. "48,686")
+    QString capacityDigits;
+    for (QChar c : fields[2]) {
+        if (c.unicode() >= '0' && c.unicode() <= '9') {
+            capacityDigits += c;
+        }
+    }
+    record.capacity = qMax(0, capacityDigits.toInt());
+
+    record.location = fields[3].trimmed();
+    record.surface = fields[4].trimmed();
+    record.league = fields[5].trimmed();
+
+    // Clean up date opened
+    static const QRegularExpression yearRegex("\\b\\d{4}\\b");
+    record.dateOpened = fields[6].trimmed();
+    auto match = yearRegex.match(record.dateOpened);
+    if (match.hasMatch()) {
+        record.dateOpened = match.captured(0);
+    }
+
+    // Clean up center field distance: the feet value (before any parentheses),
+    // else the first number
+    static const QRegularExpression feetRegex("(\\d+)\\s*(?:feet|$)");
+    static const QRegularExpression numberRegex("\\d+");
+    const QString centerFieldStr = fields[7].trimmed();
+    record.centerField = 0;
+    auto feetMatch = feetRegex.match(centerFieldStr);
+    if (feetMatch.hasMatch()) {
+        record.centerField = feetMatch.captured(1).toInt();
+    } else {
+        auto numberMatch = numberRegex.match(centerFieldStr);
+        if (numberMatch.hasMatch()) {
+            record.centerField = numberMatch.captured(0).toInt();
+        }
+    }
+    // Sanity check for reasonable values
+    if (record.centerField <= 0 || record.centerField > 1000) {
+        record.centerField = 0;
+    }
+
+    record.typology = fields[8].trimmed();
+    record.roof = fields[9].trimmed();
+
+    // Validate and clean data
+    if (record.league.isEmpty()) record.league = "Unknown";
+    if (record.surface.isEmpty()) record.surface = "Unknown";
+    if (record.typology.isEmpty()) record.typology = "Unknown";
+    if (record.roof.isEmpty()) record.roof = "Unknown";
+    return true;
+}
+
+const QVector<QPair<QString, double>>& TeamCsv::defaultSouvenirs() {
+    static const QVector<QPair<QString, double>> souvenirs = {
+        {"Baseball cap", 19.99},
+        {"Baseball bat", 89.39},
+        {"Team pennant", 17.99},
+        {"Autographed baseball", 29.99},
+        {"Team jersey", 199.99}
+    };
+    return souvenirs;
+}
@@ -0,0 +1,36 @@
+#ifndef TEAMCSV_H
+#define TEAMCSV_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QPair>
+
+// One cleaned row of an "MLB Information" style team CSV
+struct TeamRecord {
+    QString teamName;
+    QString stadiumName;
+    int capacity = 0;
+    QString location;
+    QString surface;
+    QString league;
+    QString dateOpened;
+    int centerField = 0;
+    QString typology;
+    QString roof;
+};
+
+class TeamCsv {
+public:
+    static const int ColumnCount = 10;
+
+    // Cleans one row ("48,686" -> 48686, "400 feet (122 m)" -> 400, blank
+    // league/surface/typology/roof -> "Unknown"). False if the row has fewer
+    // than ColumnCount fields or no team name.
+    static bool parseRow(const QStringList& fields, TeamRecord& record);
+
+    // Seeds souvenir_catalog, which every team sells
+    static const QVector<QPair<QString, double>>& defaultSouvenirs();
+};
+
+#endif // TEAMCSV_H
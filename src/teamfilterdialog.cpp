@@ -0,0 +1,58 @@
+#include "teamfilterdialog.h"
+#include "ui_teamfilterdialog.h"
+#include <QPushButton>
+
+TeamFilterDialog::TeamFilterDialog(const TeamCatalog& catalog, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::TeamFilterDialog)
+{
+    ui->setupUi(this);
+    fillList(ui->leagueList, catalog.values(TeamCatalog::League));
+    fillList(ui->roofList, catalog.values(TeamCatalog::Roof));
+    fillList(ui->surfaceList, catalog.values(TeamCatalog::Surface));
+    fillList(ui->typologyList, catalog.values(TeamCatalog::Typology));
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setText("Filter");
+
+    connect(ui->buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(ui->buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+TeamFilterDialog::~TeamFilterDialog()
+{
+    delete ui;
+}
+
+void TeamFilterDialog::fillList(QListWidget* list, const QStringList& values)
+{
+    for (const QString& value : values) {
+        QListWidgetItem* item = new QListWidgetItem(value, list);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
+    }
+}
+
+QStringList TeamFilterDialog::checkedValues(const QListWidget* list)
+{
+    QStringList values;
+    for (int i = 0; i < list->count(); ++i) {
+        if (list->item(i)->checkState() == Qt::Checked) {
+            values.append(list->item(i)->text());
+        }
+    }
+    return values;
+}
+
+TeamFilter TeamFilterDialog::filter() const
+{
+    // Nothing checked in a list means any value; 0 ("Any") means no bound
+    TeamFilter conditions;
+    conditions.leagues = checkedValues(ui->leagueList);
+    conditions.roofs = checkedValues(ui->roofList);
+    conditions.surfaces = checkedValues(ui->surfaceList);
+    conditions.typologies = checkedValues(ui->typologyList);
+    conditions.minCapacity = ui->minCapacitySpin->value();
+    conditions.maxCapacity = ui->maxCapacitySpin->value();
+    conditions.minCenterField = ui->minCenterFieldSpin->value();
+    conditions.maxCenterField = ui->maxCenterFieldSpin->value();
+    return conditions;
+}
@@ -0,0 +1,32 @@
+#ifndef TEAMFILTERDIALOG_H
+#define TEAMFILTERDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+#include "teamcatalog.h"
+
+namespace Ui {
+class TeamFilterDialog;
+}
+
+// Picks a combination of league / roof / surface / typology values and
+// capacity / center-field ranges for TeamCatalog::filter(). The value lists
+// offer what is currently in the catalog.
+class TeamFilterDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit TeamFilterDialog(const TeamCatalog& catalog, QWidget *parent = nullptr);
+    ~TeamFilterDialog();
+
+    TeamFilter filter() const;
+
+private:
+    static void fillList(QListWidget* list, const QStringList& values);
+    static QStringList checkedValues(const QListWidget* list);
+
+    Ui::TeamFilterDialog *ui;
+};
+
+#endif // TEAMFILTERDIALOG_H
@@ -0,0 +1,120 @@
+#include "teamstadiumindex.h"
+#include <QSet>
+
+void TeamStadiumIndex::sync(const HashMap<QString, StadiumInfo>& teams)
+{
+    QSet<QString> present;
+    present.reserve(teams.size());
+    for (const auto& entry : teams) {
+        present.insert(entry.key);
+        upsert(entry.key, entry.value.stadiumName);
+    }
+    QStringList gone;
+    for (auto it = idByTeam.constBegin(); it != idByTeam.constEnd(); ++it) {
+        if (!present.contains(it.key())) {
+            gone.append(it.key());
+        }
+    }
+    for (const QString& team : gone) {
+        remove(team);
+    }
+}
+
+void TeamStadiumIndex::upsert(const QString& teamName, const QString& stadiumName)
+{
+    const QString stadium = stadiumName.trimmed();
+    const int key = stadiumKeys.intern(stadium);
+    int id = idByTeam.value(teamName, -1);
+    if (id >= 0) {
+        entries[id].stadium = stadium;
+        if (entries[id].stadiumKey == key) {
+            return;
+        }
+        release(id);
+    } else {
+        id = entries.size();
+        entries.append(Entry());
+        entries[id].team = teamName;
+        entries[id].stadium = stadium;
+        idByTeam.insert(teamName, id);
+    }
+    entries[id].stadiumKey = key;
+    if (key < 0) {
+        return;
+    }
+    if (key >= teamByStadiumKey.size()) {
+        teamByStadiumKey.resize(key + 1, -1);
+    }
+    if (teamByStadiumKey[key] < 0) {
+        teamByStadiumKey[key] = id;
+    }
+}
+
+void TeamStadiumIndex::remove(const QString& teamName)
+{
+    const int id = idByTeam.value(teamName, -1);
+    if (id < 0) {
+        return;
+    }
+    release(id);
+    idByTeam.remove(teamName);
+    entries[id] = Entry();
+}
+
+void TeamStadiumIndex::release(int id)
+{
+    const int key = entries[id].stadiumKey;
+    entries[id].stadiumKey = -1;
+    if (key < 0 || teamByStadiumKey[key] != id) {
+        return;
+    }
+    // Hand the stadium to another team playing there, if any (rare, so a scan)
+    teamByStadiumKey[key] = -1;
+    for (int other = 0; other < entries.size(); ++other) {
+        if (other != id && entries[other].stadiumKey == key) {
+            teamByStadiumKey[key] = other;
+            break;
+        }
+    }
+}
+
+int TeamStadiumIndex::teamId(const QString& teamName) const
+{
+    return idByTeam.value(teamName, -1);
+}
+
+int TeamStadiumIndex::teamIdForStadium(QStringView stadium) const
+{
+    const int key = stadiumKeys.find(stadium);
+    return key >= 0 && key < teamByStadiumKey.size() ? teamByStadiumKey[key] : -1;
+}
+
+QString TeamStadiumIndex::graphName(int id) const
+{
+    const int key = entries[id].stadiumKey;
+    return key >= 0 ? stadiumKeys[key] : QString();
+}
+
+QString TeamStadiumIndex::teamForStadium(QStringView stadium) const
+{
+    const int id = teamIdForStadium(stadium);
+    return id >= 0 ? entries[id].team : stadium.toString();
+}
+
+QString TeamStadiumIndex::graphNameForTeam(const QString& teamName) const
+{
+    const int id = teamId(teamName);
+    return id >= 0 ? graphName(id) : QString();
+}
+
+QStringList TeamStadiumIndex::stadiumNames() const
+{
+    QStringList names;
+    names.reserve(idByTeam.size());
+    for (const Entry& entry : entries) {
+        if (!entry.team.isEmpty()) {
+            names.append(entry.stadium);
+        }
+    }
+    return names;
+}
@@ -0,0 +1,51 @@
+#ifndef TEAMSTADIUMINDEX_H
+#define TEAMSTADIUMINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include "hashmap.h"
+#include "stadiumnameindex.h"
+
+// Two-way map between team names, their stadiums' display names, the
+// normalized names StadiumGraph uses, and dense team IDs. Turning a route of
+// graph names back into teams is one probe per stop instead of a scan of the
+// stadium map that renormalizes every entry.
+//
+// Owned by Database and brought up to date by sync() after each reload; team
+// IDs stay put while a team exists. When teams share a stadium, the stadium
+// maps to the first of them.
+class TeamStadiumIndex {
+public:
+    void sync(const HashMap<QString, StadiumInfo>& teams);
+    void upsert(const QString& teamName, const QString& stadiumName);
+    void remove(const QString& teamName);
+
+    int teamId(const QString& teamName) const;           // -1 if unknown
+    int teamIdForStadium(QStringView stadium) const;     // any spelling; -1 if unknown
+    const QString& teamName(int id) const { return entries[id].team; }
+    const QString& stadiumName(int id) const { return entries[id].stadium; }
+    QString graphName(int id) const;                     // empty if the stadium has no usable name
+
+    QString teamForStadium(QStringView stadium) const;   // the input itself if unknown
+    QString graphNameForTeam(const QString& teamName) const;  // empty if unknown
+    QStringList stadiumNames() const;                    // display names, one per team
+
+private:
+    struct Entry {
+        QString team;        // empty once removed
+        QString stadium;
+        int stadiumKey = -1; // into stadiumKeys
+    };
+
+    void release(int id);    // drops the team's claim on its stadium
+
+    QVector<Entry> entries;          // team ID -> names
+    QHash<QString, int> idByTeam;
+    StadiumNameIndex stadiumKeys;    // normalized stadium names, interned
+    QVector<int> teamByStadiumKey;   // stadium key -> team ID, -1 if none
+};
+
+#endif // TEAMSTADIUMINDEX_H
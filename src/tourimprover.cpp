@@ -0,0 +1,241 @@
+#include "tourimprover.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+// Only count moves that save more than rounding noise, so the search cannot cycle
+const double Epsilon = 1e-9;
+}
+
+TourImprover::TourImprover(const QVector<double>& distances, int nodeCount, int neighborCount)
+    : n(nodeCount), dist(distances), neighbors(nodeCount) {
+    // Unreachable pairs become a large finite penalty so moves never favor them
+    double longest = 0.0;
+    for (double value : dist) {
+        longest = qMax(longest, value);
+    }
+    for (double& value : dist) {
+        if (value < 0) {
+            value = (longest + 1.0) * n;
+        }
+    }
+
+    int k = qMax(0, qMin(neighborCount, n - 1));
+    for (int a = 0; a < n; ++a) {
+        QVector<int> others(n);
+        std::iota(others.begin(), others.end(), 0);
+        others.removeAt(a);
+        std::partial_sort(others.begin(), others.begin() + k, others.end(),
+                          [&](int x, int y) { return d(a, x) < d(a, y); });
+        others.resize(k);
+        neighbors[a] = others;
+    }
+}
+
+double TourImprover::pathLength(const QVector<int>& order) const {
+    double total = 0.0;
+    for (int i = 0; i + 1 < order.size(); ++i) {
+        total += d(order[i], order[i + 1]);
+    }
+    return total;
+}
+
+double TourImprover::edge(int p, int q) const {
+    const int m = tour.size();
+    if (p < 0 || q < 0 || p >= m || q >= m) {
+        return 0.0;
+    }
+    return d(tour[p], tour[q]);
+}
+
+double TourImprover::improve(QVector<int>& order, bool fixStart, int timeBudgetMs) {
+    tour = order;
+    const int m = tour.size();
+    if (m < 3) {
+        return pathLength(order);
+    }
+    pos = QVector<int>(n, -1);
+    for (int p = 0; p < m; ++p) {
+        pos[tour[p]] = p;
+    }
+    firstMovable = fixStart ? 1 : 0;
+    dontLook = QVector<bool>(n, true);
+    queue.clear();
+    for (int city : tour) {
+        dontLook[city] = false;
+        queue.append(city);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    int head = 0;
+    while (head < queue.size() && timer.elapsed() < timeBudgetMs) {
+        int city = queue[head++];
+        if (dontLook[city]) {
+            continue;
+        }
+        if (tryTwoOpt(city) || tryOrOpt(city)) {
+            // Look at this city again once the stops around it have settled
+            queue.append(city);
+        } else {
+            dontLook[city] = true;
+        }
+        if (head > 4096 && head * 2 > queue.size()) {
+            queue.remove(0, head);
+            head = 0;
+        }
+    }
+
+    order = tour;
+    return pathLength(order);
+}
+
+int TourImprover::cityAt(int position) const {
+    return (position < 0 || position >= tour.size()) ? -1 : tour[position];
+}
+
+void TourImprover::wake(int city) {
+    if (city >= 0 && dontLook[city]) {
+        dontLook[city] = false;
+        queue.append(city);
+    }
+}
+
+void TourImprover::reverse(int from, int to) {
+    while (from < to) {
+        std::swap(tour[from], tour[to]);
+        pos[tour[from]] = from;
+        pos[tour[to]] = to;
+        ++from;
+        --to;
+    }
+}
+
+bool TourImprover::tryTwoOpt(int city) {
+    const int m = tour.size();
+    const int pa = pos[city];
+    const int lowest = firstMovable - 1;
+    for (int c : neighbors[city]) {
+        const int pc = pos[c];
+        if (pc < 0) {
+            continue;
+        }
+        const double join = d(city, c);
+        // Candidates are sorted, so once joining costs more than both edges at
+        // this city there is nothing left to gain
+        if (join >= qMax(edge(pa, pa + 1), edge(pa - 1, pa))) {
+            break;
+        }
+        const int lo = qMin(pa, pc);
+        const int hi = qMax(pa, pc);
+        // Reversing tour[i + 1 .. j] replaces edges (i, i+1) and (j, j+1) with
+        // (i, j) and (i+1, j+1); try it with city/c on either side of the cut
+        const int cuts[2][2] = {{lo, hi}, {lo - 1, hi - 1}};
+        for (const auto& cut : cuts) {
+            const int i = cut[0];
+            const int j = cut[1];
+            if (i < lowest || i >= j || j >= m) {
+                continue;
+            }
+            const double delta = edge(i, j) + edge(i + 1, j + 1) - edge(i, i + 1) - edge(j, j + 1);
+            if (delta < -Epsilon) {
+                reverse(i + 1, j);
+                wake(cityAt(i));
+                wake(cityAt(i + 1));
+                wake(cityAt(j));
+                wake(cityAt(j + 1));
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TourImprover::tryOrOpt(int city) {
+    const int m = tour.size();
+    const int start = pos[city];
+    if (start < firstMovable) {
+        return false;
+    }
+    for (int length = 1; length <= 3; ++length) {
+        const int last = start + length - 1;
+        if (last >= m || m - length < 2) {
+            break;
+        }
+        const int head = tour[start];
+        const int tail = tour[last];
+        // What cutting the segment out saves, counting the edge that closes the gap
+        const double removeGain = edge(start - 1, start) + edge(last, last + 1)
+                                  - edge(start - 1, last + 1);
+        if (removeGain <= Epsilon) {
+            continue;
+        }
+        for (int end : {head, tail}) {
+            for (int c : neighbors[end]) {
+                const int pc = pos[c];
+                if (pc < 0 || (pc >= start && pc <= last)) {
+                    continue;
+                }
+                if (d(end, c) >= removeGain) {
+                    break;
+                }
+                // Insert into the gap just before or just after c
+                for (int gap : {pc - 1, pc}) {
+                    if (gap < firstMovable - 1 || gap >= m || (gap >= start - 1 && gap <= last)) {
+                        continue;
+                    }
+                    const bool openLeft = gap < 0;
+                    const bool openRight = gap + 1 >= m;
+                    const int u = openLeft ? -1 : tour[gap];
+                    const int v = openRight ? -1 : tour[gap + 1];
+                    auto link = [&](int x, int y) { return (x < 0 || y < 0) ? 0.0 : d(x, y); };
+                    const double forward = link(u, head) + link(tail, v);
+                    const double backward = link(u, tail) + link(head, v);
+                    const double addCost = qMin(forward, backward) - link(u, v);
+                    if (addCost - removeGain < -Epsilon) {
+                        moveSegment(start, last, gap, backward < forward);
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void TourImprover::moveSegment(int first, int last, int gap, bool reversed) {
+    // Rebuild the path with tour[first .. last] placed after position gap
+    const int before = cityAt(first - 1);
+    const int after = cityAt(last + 1);
+    QVector<int> segment = tour.mid(first, last - first + 1);
+    if (reversed) {
+        std::reverse(segment.begin(), segment.end());
+    }
+    QVector<int> rebuilt;
+    rebuilt.reserve(tour.size());
+    if (gap < 0) {
+        rebuilt += segment;
+    }
+    for (int p = 0; p < tour.size(); ++p) {
+        if (p >= first && p <= last) {
+            continue;
+        }
+        rebuilt.append(tour[p]);
+        if (p == gap) {
+            rebuilt += segment;
+        }
+    }
+    tour = rebuilt;
+    for (int p = 0; p < tour.size(); ++p) {
+        pos[tour[p]] = p;
+    }
+    // Wake the segment, its new neighbors and the stops that closed the old gap
+    for (int city : segment) {
+        wake(city);
+        wake(cityAt(pos[city] - 1));
+        wake(cityAt(pos[city] + 1));
+    }
+    wake(before);
+    wake(after);
+}
@@ -0,0 +1,46 @@
+#ifndef TOURIMPROVER_H
+#define TOURIMPROVER_H
+
+#include <QVector>
+
+// Local search for open paths over a row-major distance matrix: 2-opt
+// (segment reversal) and Or-opt (moving a run of 1-3 stops elsewhere, either
+// way round). Moves are only tried towards each stop's nearest candidates,
+// and don't-look bits skip stops whose surroundings have not changed since
+// they last failed to improve.
+class TourImprover {
+public:
+    // dist is n x n, negative (no path) entries are treated as very long
+    TourImprover(const QVector<double>& dist, int n, int neighborCount = 8);
+
+    // Improves order (each index at most once) in place until no move helps
+    // or the time budget runs out. With fixStart the first stop stays first.
+    // Returns the new path length.
+    double improve(QVector<int>& order, bool fixStart = true, int timeBudgetMs = 200);
+
+    double pathLength(const QVector<int>& order) const;
+
+private:
+    double d(int a, int b) const { return dist[a * n + b]; }
+    // Cost of the edge between tour positions p and q; the open ends cost nothing
+    double edge(int p, int q) const;
+    bool tryTwoOpt(int city);
+    bool tryOrOpt(int city);
+    void reverse(int from, int to);
+    void moveSegment(int first, int last, int gap, bool reversed);
+    int cityAt(int position) const; // -1 past either end
+    void wake(int city);
+
+    int n;
+    QVector<double> dist;
+    QVector<QVector<int>> neighbors; // k nearest cities, closest first
+
+    // State of the current improve() call
+    QVector<int> tour;
+    QVector<int> pos;
+    QVector<bool> dontLook;
+    QVector<int> queue;
+    int firstMovable = 0;
+};
+
+#endif // TOURIMPROVER_H
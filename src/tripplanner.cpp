@@ -9,11 +9,14 @@
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QProgressDialog>
+#include "heldkarp.h"
 
-TripPlanner::TripPlanner(const HashMap<QString, StadiumInfo>& stadiumMap, StadiumGraph* stadiumGraph, QWidget *parent)
+TripPlanner::TripPlanner(const HashMap<QString, StadiumInfo>& stadiumMap, const TeamStadiumIndex& teamIndex,
+                         StadiumGraph* stadiumGraph, QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::TripPlanner)
     , stadiumMap(stadiumMap)
+    , teamIndex(teamIndex)
     , stadiumGraph(stadiumGraph)
 {
     ui->setupUi(this);
@@ -49,19 +52,15 @@ void TripPlanner::on_dijkstraButton_clicked()
         return;
     }
     QString startTeam = ui->tripStadiumsList->item(0)->text();
-    StadiumInfo startInfo;
-    if (!stadiumMap.get(startTeam, startInfo)) {
+    const StadiumInfo* startInfo = stadiumMap.find(startTeam);
+    if (!startInfo) {
         QMessageBox::warning(this, "Error", QString("Could not find stadium for team '%1'").arg(startTeam));
         return;
     }
-    QString startStadium = startInfo.stadiumName.trimmed();
+    QString startStadium = startInfo->stadiumName.trimmed();
 
     // Get all user-friendly stadium names for the dropdown
-    QVector<QString> stadiums;
-    QVector<QPair<QString, StadiumInfo>> entries = stadiumMap.getAllEntries();
-    for (const auto& entry : entries) {
-        stadiums.append(entry.second.stadiumName.trimmed());
-    }
+    QStringList stadiums = teamIndex.stadiumNames();
     bool ok = false;
     QString endStadium = QInputDialog::getItem(this, "Select Destination", "Choose destination stadium:", stadiums, 0, false, &ok);
     if (!ok || startStadium.isEmpty() || endStadium.isEmpty()) {
@@ -71,22 +70,20 @@ void TripPlanner::on_dijkstraButton_clicked()
     // Normalize for lookup
     QString nStart = StadiumGraph::normalizeStadiumName(startStadium);
     QString nEnd = StadiumGraph::normalizeStadiumName(endStadium);
-    QVector<QString> normalizedStadiums;
-    for (const QString& s : stadiums) normalizedStadiums << StadiumGraph::normalizeStadiumName(s);
-    if (!normalizedStadiums.contains(nStart)) {
+    if (teamIndex.teamIdForStadium(startStadium) < 0) {
         QMessageBox::warning(this, "Error", QString("Start stadium '%1' not found in graph.").arg(startStadium));
         return;
     }
-    if (!normalizedStadiums.contains(nEnd)) {
+    if (teamIndex.teamIdForStadium(endStadium) < 0) {
         QMessageBox::warning(this, "Error", QString("End stadium '%1' not found in graph.").arg(endStadium));
         return;
     }
     // Defensive: Check that both stadiums exist in the graph adjacency matrix
-    if (!stadiumGraph->getStadiums().contains(StadiumGraph::normalizeStadiumName(startStadium))) {
+    if (!stadiumGraph->hasStadium(startStadium)) {
         QMessageBox::warning(this, "Error", QString("Start stadium '%1' not found in graph adjacency matrix.").arg(startStadium));
         return;
     }
-    if (!stadiumGraph->getStadiums().contains(StadiumGraph::normalizeStadiumName(endStadium))) {
+    if (!stadiumGraph->hasStadium(endStadium)) {
         QMessageBox::warning(this, "Error", QString("End stadium '%1' not found in graph adjacency matrix.").arg(endStadium));
         return;
     }
@@ -134,8 +131,11 @@ void TripPlanner::on_dijkstraButton_clicked()
 void TripPlanner::on_mstButton_clicked()
 {
     QVector<QPair<QString, QString>> mst;
-    double totalWeight = stadiumGraph->minimumSpanningTree(mst);
-    QString summary = "Minimum Spanning Tree:\n";
+    int components = 1;
+    double totalWeight = stadiumGraph->minimumSpanningTree(mst, &components);
+    QString summary = components > 1
+        ? QString("Minimum Spanning Forest (%1 disconnected components):\n").arg(components)
+        : QString("Minimum Spanning Tree:\n");
     int validEdgeCount = 0;
     QSet<QString> stadiumsInMST;
     for (const auto& edge : mst) {
@@ -176,10 +176,9 @@ void TripPlanner::on_dfsButton_clicked()
     } else {
         teamName = "San Francisco Giants";
     }
-    StadiumInfo info;
     QString startStadium;
-    if (stadiumMap.get(teamName, info)) {
-        startStadium = info.stadiumName.trimmed();
+    if (const StadiumInfo* info = stadiumMap.find(teamName)) {
+        startStadium = info->stadiumName.trimmed();
     } else {
         startStadium = teamName;
     }
@@ -244,10 +243,9 @@ void TripPlanner::on_bfsButton_clicked()
     } else {
         teamName = "Minnesota Twins";
     }
-    StadiumInfo info;
     QString startStadium;
-    if (stadiumMap.get(teamName, info)) {
-        startStadium = info.stadiumName.trimmed();
+    if (const StadiumInfo* info = stadiumMap.find(teamName)) {
+        startStadium = info->stadiumName.trimmed();
     } else {
         startStadium = teamName;
     }
@@ -377,51 +375,82 @@ void TripPlanner::on_aStarButton_clicked() {
 }
 
 void TripPlanner::on_greedyButton_clicked() {
-    // Use the official MLB reference order
-    QVector<QString> referenceOrder = {
-        "marlins park", "tropicana field", "great american ball park", "progressive field", "comerica park", "pnc park", "nationals park", "oriole park at camden yards", "citizens bank park", "yankee stadium", "citi field", "fenway park", "rogers centre", "miller park", "wrigley field", "guaranteed rate field", "target field", "busch stadium", "kauffman stadium", "globe life park in arlington", "minute maid park", "coors field", "chase field", "petco park", "angel stadium", "dodger stadium", "oakland-alameda county coliseum", "oracle park", "safeco field", "suntrust park"
-    };
-    double totalDistance = 0.0;
-    QVector<QString> fullPath;
-    for (int i = 0; i < referenceOrder.size() - 1; ++i) {
-        QVector<QString> segmentPath;
-        double dist = stadiumGraph->dijkstra(referenceOrder[i], referenceOrder[i+1], segmentPath);
-        if (dist < 0 || segmentPath.isEmpty()) {
-            qDebug() << "[ERROR] No path between" << referenceOrder[i] << "and" << referenceOrder[i+1];
-            QMessageBox::warning(this, "Trip Error", QString("No path between '%1' and '%2'.").arg(referenceOrder[i], referenceOrder[i+1]));
-            ui->tripSummaryText->setText("No path between selected stadiums.");
+    // Provably shortest order through every stadium in the graph, starting at Marlins Park.
+    // Solved in the background; expansion teams are picked up automatically.
+    QProgressDialog* progress = new QProgressDialog("Finding the shortest route through every stadium...", QString(), 0, 0, this);
+    progress->setWindowModality(Qt::ApplicationModal);
+    progress->setCancelButton(nullptr);
+    progress->setMinimumDuration(0);
+    progress->show();
+    const quint64 graphVersion = stadiumGraph->version();
+    QFuture<VisitAllResult> future = QtConcurrent::run([=]() {
+        VisitAllResult result;
+        result.distance = stadiumGraph->optimalTour("marlins park", result.order, 10000, &result.gap);
+        return result;
+    });
+    QFutureWatcher<VisitAllResult>* watcher = new QFutureWatcher<VisitAllResult>(this);
+    connect(watcher, &QFutureWatcher<VisitAllResult>::finished, this, [=]() {
+        progress->close();
+        VisitAllResult result = watcher->result();
+        watcher->deleteLater();
+        progress->deleteLater();
+        if (result.distance < 0 || result.order.isEmpty()) {
+            QMessageBox::warning(this, "Trip Error", "Could not find a route through every stadium from Marlins Park.");
+            ui->tripSummaryText->setText("Could not find a route through every stadium.");
             ui->totalDistanceLabel->setText("Total Distance: 0 miles");
             return;
         }
-        // Avoid duplicating the starting stadium of each segment (except the first)
-        if (i == 0) {
-            fullPath += segmentPath;
-        } else {
-            for (int j = 1; j < segmentPath.size(); ++j) {
-                fullPath.append(segmentPath[j]);
+        lastVisitAll = result;
+        lastVisitAllVersion = graphVersion;
+
+        double totalDistance = 0.0;
+        QVector<QString> fullPath;
+        for (int i = 0; i < result.order.size() - 1; ++i) {
+            QVector<QString> segmentPath;
+            double dist = stadiumGraph->dijkstra(result.order[i], result.order[i+1], segmentPath);
+            if (dist < 0 || segmentPath.isEmpty()) {
+                qDebug() << "[ERROR] No path between" << result.order[i] << "and" << result.order[i+1];
+                QMessageBox::warning(this, "Trip Error", QString("No path between '%1' and '%2'.").arg(result.order[i], result.order[i+1]));
+                ui->tripSummaryText->setText("No path between selected stadiums.");
+                ui->totalDistanceLabel->setText("Total Distance: 0 miles");
+                return;
             }
+            // Avoid duplicating the starting stadium of each segment (except the first)
+            if (i == 0) {
+                fullPath += segmentPath;
+            } else {
+                for (int j = 1; j < segmentPath.size(); ++j) {
+                    fullPath.append(segmentPath[j]);
+                }
+            }
+            totalDistance += dist;
         }
-        totalDistance += dist;
-    }
-    QString summary = "Visit All (Marlins Park, Shortest Paths):\n";
-    for (int i = 0; i < fullPath.size(); ++i) {
-        summary += fullPath[i];
-        if (i < fullPath.size() - 1) summary += " -> ";
-    }
-    summary += QString("\n\nTotal Distance: %1 miles").arg(totalDistance, 0, 'f', 2);
-    ui->tripSummaryText->setText(summary);
-    ui->totalDistanceLabel->setText(QString("Total Distance: %1 miles").arg(totalDistance, 0, 'f', 2));
-    // Update Trip Stadiums list
-    ui->tripStadiumsList->clear();
-    for (const QString& stadium : fullPath) {
-        ui->tripStadiumsList->addItem(findTeamNameByStadium(stadium));
-    }
-    if (ui->tripStadiumsList->count() > 0) {
-        ui->tripStadiumsList->setCurrentRow(0);
-        updateSouvenirTableForSelectedStadium();
-    }
-    // Final summary debug output
-    qDebug() << "[SUMMARY] Reference trip order used. Total mileage:" << totalDistance;
+        QString summary = "Visit All (Marlins Park, Optimal Order):\n";
+        for (int i = 0; i < fullPath.size(); ++i) {
+            summary += fullPath[i];
+            if (i < fullPath.size() - 1) summary += " -> ";
+        }
+        summary += QString("\n\nTotal Distance: %1 miles").arg(totalDistance, 0, 'f', 2);
+        if (result.gap > 0) {
+            summary += QString("\n(Search stopped at the time limit; at most %1% above optimal)").arg(result.gap * 100.0, 0, 'f', 2);
+        } else {
+            summary += "\n(Proven optimal)";
+        }
+        ui->tripSummaryText->setText(summary);
+        ui->totalDistanceLabel->setText(QString("Total Distance: %1 miles").arg(totalDistance, 0, 'f', 2));
+        // Update Trip Stadiums list
+        ui->tripStadiumsList->clear();
+        for (const QString& stadium : fullPath) {
+            ui->tripStadiumsList->addItem(findTeamNameByStadium(stadium));
+        }
+        if (ui->tripStadiumsList->count() > 0) {
+            ui->tripStadiumsList->setCurrentRow(0);
+            updateSouvenirTableForSelectedStadium();
+        }
+        // Final summary debug output
+        qDebug() << "[SUMMARY] Optimal visit-all order. Total mileage:" << totalDistance << "gap:" << result.gap;
+    });
+    watcher->setFuture(future);
 }
 
 void TripPlanner::updateSouvenirTableForSelectedStadium() {
@@ -433,11 +462,12 @@ void TripPlanner::updateSouvenirTableForSelectedStadium() {
         selectedTeam = ui->tripStadiumsList->item(0)->text();
     else
         selectedTeam = "";
-    StadiumInfo info;
-    if (!selectedTeam.isEmpty() && stadiumMap.get(selectedTeam, info)) {
-        ui->souvenirTable->setRowCount(info.souvenirs.size());
-        for (int i = 0; i < info.souvenirs.size(); ++i) {
-            const auto& souvenir = info.souvenirs[i];
+    const StadiumInfo* info = selectedTeam.isEmpty() ? nullptr : stadiumMap.find(selectedTeam);
+    if (info) {
+        const QVector<Souvenir> souvenirs = info->souvenirs.items();
+        ui->souvenirTable->setRowCount(souvenirs.size());
+        for (int i = 0; i < souvenirs.size(); ++i) {
+            const auto& souvenir = souvenirs[i];
             QTableWidgetItem* nameItem = new QTableWidgetItem(souvenir.first);
             nameItem->setFlags(nameItem->flags() & ~Qt::ItemIsEditable);
             ui->souvenirTable->setItem(i, 0, nameItem);
@@ -460,15 +490,7 @@ void TripPlanner::on_customOrderTripButton_clicked() {
     // Get stadiums in the order shown in tripStadiumsList, map team name to stadium name, normalize
     QVector<QString> stadiums;
     for (int i = 0; i < ui->tripStadiumsList->count(); ++i) {
-        QString teamOrStadium = ui->tripStadiumsList->item(i)->text().trimmed();
-        StadiumInfo info;
-        QString stadiumName;
-        if (stadiumMap.get(teamOrStadium, info)) {
-            stadiumName = info.stadiumName.trimmed();
-        } else {
-            stadiumName = teamOrStadium;
-        }
-        stadiums.append(StadiumGraph::normalizeStadiumName(stadiumName));
+        stadiums.append(graphNameForStop(ui->tripStadiumsList->item(i)->text().trimmed()));
     }
     qDebug() << "Custom Order Trip normalized stadiums:" << stadiums;
     if (stadiums.size() < 2) {
@@ -523,23 +545,15 @@ void TripPlanner::on_visitAllMarlinsButton_clicked() {
 void TripPlanner::on_dreamVacationButton_clicked() {
     QVector<QString> stadiums;
     for (int i = 0; i < ui->tripStadiumsList->count(); ++i) {
-        QString teamOrStadium = ui->tripStadiumsList->item(i)->text().trimmed();
-        StadiumInfo info;
-        QString stadiumName;
-        if (stadiumMap.get(teamOrStadium, info)) {
-            stadiumName = info.stadiumName.trimmed();
-        } else {
-            stadiumName = teamOrStadium;
-        }
-        stadiums.append(StadiumGraph::normalizeStadiumName(stadiumName));
+        stadiums.append(graphNameForStop(ui->tripStadiumsList->item(i)->text().trimmed()));
     }
     qDebug() << "Dream Vacation normalized stadiums:" << stadiums;
     if (stadiums.size() < 2) {
         QMessageBox::warning(this, "Trip Error", "Please select at least two stadiums for a dream vacation trip.");
         return;
     }
-    if (stadiums.size() <= 8) {
-        // Brute-force in a background thread
+    if (stadiums.size() <= HeldKarpSolver::MaxStops) {
+        // Exact Held-Karp search in a background thread
         QProgressDialog* progress = new QProgressDialog("Finding optimal trip order...", QString(), 0, 0, this);
         progress->setWindowModality(Qt::ApplicationModal);
         progress->setCancelButton(nullptr);
@@ -548,22 +562,22 @@ void TripPlanner::on_dreamVacationButton_clicked() {
         QFuture<QPair<QVector<QString>, double>> future = QtConcurrent::run([=]() {
             QVector<QString> bestOrder;
             double minDistance = std::numeric_limits<double>::infinity();
-        QVector<QString> perm = stadiums;
-        std::sort(perm.begin(), perm.end());
-        do {
-            double dist = 0.0;
-            bool valid = true;
-            for (int i = 0; i < perm.size() - 1; ++i) {
-                QVector<QString> segmentPath;
-                double d = stadiumGraph->dijkstra(perm[i], perm[i+1], segmentPath);
-                if (d < 0 || segmentPath.isEmpty()) { valid = false; break; }
-                dist += d;
+            // Sorted so ties resolve the same way as the old permutation search
+            QVector<QString> sorted = stadiums;
+            std::sort(sorted.begin(), sorted.end());
+            const int k = sorted.size();
+            QVector<double> pairDist(k * k);
+            for (int a = 0; a < k; ++a) {
+                for (int b = 0; b < k; ++b) {
+                    pairDist[a * k + b] = stadiumGraph->shortestDistance(sorted[a], sorted[b]);
+                }
             }
-            if (valid && dist < minDistance) {
+            QVector<int> order;
+            double dist = HeldKarpSolver::solve(pairDist, k, order);
+            if (dist >= 0) {
                 minDistance = dist;
-                bestOrder = perm;
+                for (int idx : order) bestOrder.append(sorted[idx]);
             }
-        } while (std::next_permutation(perm.begin(), perm.end()));
             return QPair<QVector<QString>, double>(bestOrder, minDistance);
         });
         QFutureWatcher<QPair<QVector<QString>, double>>* watcher = new QFutureWatcher<QPair<QVector<QString>, double>>(this);
@@ -596,7 +610,7 @@ void TripPlanner::on_dreamVacationButton_clicked() {
                 }
                 if (i == 0) {
                     fullPath += segmentPath;
-    } else {
+                } else {
                     for (int j = 1; j < segmentPath.size(); ++j) {
                         fullPath.append(segmentPath[j]);
                     }
@@ -626,43 +640,41 @@ void TripPlanner::on_dreamVacationButton_clicked() {
         watcher->setFuture(future);
         return;
     }
-    // ... existing nearest neighbor heuristic code for >8 stadiums ...
-        QVector<QString> toVisit = stadiums;
-        QVector<QString> order;
-        QString current = toVisit.takeFirst();
-        order.append(current);
-        while (!toVisit.isEmpty()) {
-            double bestDist = std::numeric_limits<double>::infinity();
-            int bestIdx = -1;
-            QVector<QString> bestPath;
-            for (int i = 0; i < toVisit.size(); ++i) {
-                QVector<QString> segmentPath;
-                double d = stadiumGraph->dijkstra(current, toVisit[i], segmentPath);
-                if (d >= 0 && d < bestDist) {
-                    bestDist = d;
-                    bestIdx = i;
-                    bestPath = segmentPath;
-                }
-            }
-            if (bestIdx == -1) {
-                QMessageBox::warning(this, "Trip Error", "No path between some stadiums in the selection.");
-                ui->tripSummaryText->setText("No path between some stadiums in the selection.");
-                ui->totalDistanceLabel->setText("Total Distance: 0 miles");
-                return;
+    // Too many stops for the exact search: nearest neighbor heuristic
+    QVector<QString> toVisit = stadiums;
+    QVector<QString> order;
+    QString current = toVisit.takeFirst();
+    order.append(current);
+    while (!toVisit.isEmpty()) {
+        double bestDist = std::numeric_limits<double>::infinity();
+        int bestIdx = -1;
+        for (int i = 0; i < toVisit.size(); ++i) {
+            double d = stadiumGraph->shortestDistance(current, toVisit[i]);
+            if (d >= 0 && d < bestDist) {
+                bestDist = d;
+                bestIdx = i;
             }
-            current = toVisit.takeAt(bestIdx);
-            order.append(current);
         }
+        if (bestIdx == -1) {
+            QMessageBox::warning(this, "Trip Error", "No path between some stadiums in the selection.");
+            ui->tripSummaryText->setText("No path between some stadiums in the selection.");
+            ui->totalDistanceLabel->setText("Total Distance: 0 miles");
+            return;
+        }
+        current = toVisit.takeAt(bestIdx);
+        order.append(current);
+    }
+    // Tighten the greedy order with 2-opt/Or-opt (the start is free, as in the exact search)
+    stadiumGraph->improveTour(order, false);
     QVector<QString> bestOrder = order;
     double minDistance = 0.0;
-        for (int i = 0; i < bestOrder.size() - 1; ++i) {
-            QVector<QString> segmentPath;
-            double d = stadiumGraph->dijkstra(bestOrder[i], bestOrder[i+1], segmentPath);
-            if (d < 0 || segmentPath.isEmpty()) {
-                minDistance = std::numeric_limits<double>::infinity();
-                break;
-            }
-            minDistance += d;
+    for (int i = 0; i < bestOrder.size() - 1; ++i) {
+        double d = stadiumGraph->shortestDistance(bestOrder[i], bestOrder[i+1]);
+        if (d < 0) {
+            minDistance = std::numeric_limits<double>::infinity();
+            break;
+        }
+        minDistance += d;
     }
     if (bestOrder.isEmpty() || minDistance == std::numeric_limits<double>::infinity()) {
         QMessageBox::warning(this, "Trip Error", "Could not find a valid optimized trip order.");
@@ -721,10 +733,10 @@ void TripPlanner::refreshStadiumLists() {
     ui->availableStadiumsList->clear();
     if (ui->dfsBfsStartCombo) ui->dfsBfsStartCombo->clear();
 
-    QVector<QPair<QString, StadiumInfo>> entries = stadiumMap.getAllEntries();
     QVector<QString> teamNames;
-    for (const auto& entry : entries) {
-        teamNames.append(entry.first);
+    teamNames.reserve(stadiumMap.size());
+    for (const auto& entry : stadiumMap) {
+        teamNames.append(entry.key);
     }
     std::sort(teamNames.begin(), teamNames.end());
     for (const QString& team : teamNames) {
@@ -734,6 +746,34 @@ void TripPlanner::refreshStadiumLists() {
     }
 }
 
+void TripPlanner::teamChanged(const QString& teamName) {
+    // Only a new team changes the lists; stops refer to teams by name
+    if (!ui->availableStadiumsList->findItems(teamName, Qt::MatchExactly).isEmpty()) {
+        return;
+    }
+    int index = 0;
+    while (index < ui->availableStadiumsList->count() && ui->availableStadiumsList->item(index)->text() < teamName) {
+        ++index;
+    }
+    ui->availableStadiumsList->insertItem(index, teamName);
+    ui->startingStadiumCombo->insertItem(index, teamName);
+    if (ui->dfsBfsStartCombo) ui->dfsBfsStartCombo->insertItem(index, teamName);
+}
+
+void TripPlanner::souvenirsChanged(const QString& teamName) {
+    QString shownTeam;
+    if (ui->tripStadiumsList->selectedItems().size() > 0)
+        shownTeam = ui->tripStadiumsList->selectedItems().first()->text();
+    else if (ui->tripStadiumsList->count() > 0)
+        shownTeam = ui->tripStadiumsList->item(0)->text();
+    if (shownTeam == teamName) {
+        updateSouvenirTableForSelectedStadium();
+    }
+    if (souvenirCart.contains(teamName)) {
+        updateOverallSouvenirSummary();  // prices may have changed
+    }
+}
+
 void TripPlanner::on_startingStadiumCombo_currentIndexChanged(const QString &stadium) {
     // Overwrite the first entry, keep the rest, no duplicates
     QList<QString> tripStadiums;
@@ -754,13 +794,9 @@ void TripPlanner::updateOverallSouvenirSummary() {
     for (auto it = souvenirCart.begin(); it != souvenirCart.end(); ++it) {
         const QString& stadium = it.key();
         const QVector<QPair<QString, int>>& items = it.value();
-        StadiumInfo info;
-        stadiumMap.get(stadium, info);
+        const StadiumInfo* info = stadiumMap.find(stadium);
         for (const auto& pair : items) {
-            double price = 0.0;
-            for (const auto& souvenir : info.souvenirs) {
-                if (souvenir.first == pair.first) price = souvenir.second;
-            }
+            double price = info ? info->souvenirs.price(pair.first) : 0.0;
             double cost = price * pair.second;
             totalCost += cost;
             ui->souvenirCartTable->insertRow(row);
@@ -839,13 +875,13 @@ void TripPlanner::on_removeSouvenirButton_clicked() {
 }
 
 QString TripPlanner::findTeamNameByStadium(const QString& normalizedStadium) const {
-    QVector<QPair<QString, StadiumInfo>> entries = stadiumMap.getAllEntries();
-    for (const auto& entry : entries) {
-        if (StadiumGraph::normalizeStadiumName(entry.second.stadiumName) == normalizedStadium) {
-            return entry.first; // team name
-        }
-    }
-    return normalizedStadium; // fallback
+    return teamIndex.teamForStadium(normalizedStadium); // the stadium itself if no team plays there
+}
+
+QString TripPlanner::graphNameForStop(const QString& teamOrStadium) const {
+    // Trip stops are team names; anything else is taken as a stadium name
+    QString name = teamIndex.graphNameForTeam(teamOrStadium);
+    return name.isEmpty() ? StadiumGraph::normalizeStadiumName(teamOrStadium) : name;
 }
 
 void TripPlanner::on_referenceTripButton_clicked() {
@@ -881,6 +917,20 @@ void TripPlanner::on_referenceTripButton_clicked() {
         if (i < fullPath.size() - 1) summary += " -> ";
     }
     summary += QString("\n\nTotal Distance: %1 miles").arg(refTotal, 0, 'f', 2);
+    // The reference order is fixed; flag stadiums it misses (e.g. expansion teams)
+    QStringList notVisited;
+    for (const QString& stadium : stadiumGraph->getStadiums()) {
+        if (!fullPath.contains(stadium)) notVisited.append(stadium);
+    }
+    if (!notVisited.isEmpty()) {
+        summary += "\nNot visited by the reference order: " + notVisited.join(", ");
+    }
+    // Compare with the optimal visit-all route if one was computed for this graph
+    if (lastVisitAll.distance > 0 && lastVisitAllVersion == stadiumGraph->version()) {
+        summary += QString("\nOptimal visit-all route: %1 miles (reference is %2% longer)")
+                       .arg(lastVisitAll.distance, 0, 'f', 2)
+                       .arg((refTotal - lastVisitAll.distance) / lastVisitAll.distance * 100.0, 0, 'f', 2);
+    }
     ui->tripSummaryText->setText(summary);
     ui->totalDistanceLabel->setText(QString("Total Distance: %1 miles").arg(refTotal, 0, 'f', 2));
     // Update Trip Stadiums list
@@ -9,6 +9,14 @@
 #include "trip.h"
 #include "hashmap.h"
 #include "stadiumgraph.h"
+#include "teamstadiumindex.h"
+
+// Result of the background visit-all search (stops in order, miles, optimality gap)
+struct VisitAllResult {
+    QVector<QString> order;
+    double distance = -1.0;
+    double gap = 0.0;
+};
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class TripPlanner; }
@@ -19,9 +27,15 @@ class TripPlanner : public QDialog
     Q_OBJECT
 
 public:
-    explicit TripPlanner(const HashMap<QString, StadiumInfo>& stadiumMap, StadiumGraph* stadiumGraph, QWidget *parent = nullptr);
+    explicit TripPlanner(const HashMap<QString, StadiumInfo>& stadiumMap, const TeamStadiumIndex& teamIndex,
+                         StadiumGraph* stadiumGraph, QWidget *parent = nullptr);
     ~TripPlanner();
+
+public slots:
     void refreshStadiumLists();
+    // Deltas from Database; the stadium map and team index are already patched
+    void teamChanged(const QString& teamName);
+    void souvenirsChanged(const QString& teamName);
 
 private slots:
     void on_dijkstraButton_clicked();
@@ -54,14 +68,18 @@ private:
     Ui::TripPlanner *ui;
     Trip currentTrip;
     const HashMap<QString, StadiumInfo>& stadiumMap;
+    const TeamStadiumIndex& teamIndex;
     StadiumGraph* stadiumGraph;
     QMap<QString, QVector<QPair<QString, int>>> souvenirCart; // stadium -> (souvenir, qty)
+    VisitAllResult lastVisitAll;      // last optimal visit-all route, for the reference comparison
+    quint64 lastVisitAllVersion = 0;  // graph version it was computed for
     void setupUi();
     void updateStopList();
     void updateTotalCost();
     void updateTotalDistance();
     void updateOverallSouvenirSummary();
     QString findTeamNameByStadium(const QString& normalizedStadium) const;
+    QString graphNameForStop(const QString& teamOrStadium) const;
 };
 
 #endif // TRIPPLANNER_H 
\ No newline at end of file